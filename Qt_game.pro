@@ -15,11 +15,17 @@ TEMPLATE = app
 SOURCES += main.cpp\
         mainwindow.cpp \
     gameboard.cpp \
-    instructions.cpp
+    instructions.cpp \
+    spriteatlas.cpp \
+    spritecache.cpp \
+    assetregistry.cpp
 
 HEADERS  += mainwindow.h \
     gameboard.h \
-    instructions.h
+    instructions.h \
+    spriteatlas.h \
+    spritecache.h \
+    assetregistry.h
 
 FORMS    += mainwindow.ui \
     gameboard.ui \
@@ -27,3 +33,5 @@ FORMS    += mainwindow.ui \
 
 RESOURCES += \
     images.qrc
+
+include(gamecore.pri)
@@ -0,0 +1,93 @@
+/** @file assetregistry.cpp
+ * @brief Contains implementation of AssetRegistry class. This class loads the images of the app once and keeps them for every screen and session.
+ */
+
+#include "assetregistry.h"
+#include "screenlayout.h"
+#include <QElapsedTimer>
+#include <QtGlobal>
+#include <vector>
+
+
+/** Constructor for AssetRegistry. Nothing is loaded until it is requested.
+ */
+AssetRegistry::AssetRegistry()
+{
+}
+
+
+/** Returns the registry of the app, creating it on first use.
+ */
+AssetRegistry& AssetRegistry::instance() {
+    static AssetRegistry registry;
+    return registry;
+}
+
+
+/** Returns an image at its own size, decoding it the first time it is requested.
+ * @param path is the resource path of the image
+ */
+const QPixmap& AssetRegistry::image(const QString& path) {
+    return sprites.image(path);
+}
+
+
+/** Returns an image scaled to the size it is drawn at, scaling it the first time that size is requested.
+ * @param path is the resource path of the image
+ * @param size is the size of the image on screen in logical pixels. An invalid size keeps the size of the image.
+ * @param dpr is the device pixel ratio of the widget the image is drawn on
+ */
+const QPixmap& AssetRegistry::scaled(const QString& path, const QSize& size, qreal dpr) {
+    return sprites.scaled(path, size, dpr);
+}
+
+
+/** Returns the atlas of every gameplay sprite scaled to the size it is drawn at, building it the first time it is requested
+ * for the given device pixel ratio. The explosion frames are numbered from 1 to 14.
+ * @param dpr is the device pixel ratio of the widget the game is drawn on
+ */
+const SpriteAtlas& AssetRegistry::game_atlas(qreal dpr) {
+    std::map<qreal, SpriteAtlas>::iterator it = atlases.find(dpr);
+    if (it != atlases.end())
+        return it->second;
+
+    QElapsedTimer clock;
+    clock.start();
+
+    std::vector<QPixmap> images(sprite_count);
+    images[sprite_invader] = scaled(":/image/IMAGES/invader.png", QSize(invader_box.width, invader_box.height), dpr);
+    images[sprite_spaceship] = scaled(":/image/IMAGES/spaceship.png", QSize(player_box.width, player_box.height), dpr);
+    images[sprite_lives_icon] = scaled(":/image/IMAGES/spaceship.png", QSize(lives_icon_box.width, lives_icon_box.height), dpr);
+    images[sprite_player_bullet] = scaled(":/image/IMAGES/player_bullet.png", QSize(bullet_box.width, bullet_box.height), dpr);
+    images[sprite_enemy_bullet] = scaled(":/image/IMAGES/enemy_bullet.png", QSize(bullet_box.width, bullet_box.height), dpr);
+    images[sprite_enemy_bullet_left] = scaled(":/image/IMAGES/enemy_bullet_left.png", QSize(boss_side_bullet_box.width, boss_side_bullet_box.height), dpr);
+    images[sprite_enemy_bullet_right] = scaled(":/image/IMAGES/enemy_bullet_right.png", QSize(boss_side_bullet_box.width, boss_side_bullet_box.height), dpr);
+    images[sprite_boss] = scaled(":/image/IMAGES/boss.png", QSize(boss_box.width, boss_box.height), dpr);
+    images[sprite_boss_text] = scaled(":/image/IMAGES/boss_message.png", QSize(boss_message_box.width, boss_message_box.height), dpr);
+    images[sprite_win_text] = scaled(":/image/IMAGES/win_message.png", QSize(win_message_box.width, win_message_box.height), dpr);
+    images[sprite_lives_remaining] = scaled(":/image/IMAGES/lives_remaining.png", QSize(lives_label_box.width, lives_label_box.height), dpr);
+    images[sprite_boss_health] = scaled(":/image/IMAGES/boss_health.png", QSize(boss_health_label_box.width, boss_health_label_box.height), dpr);
+    for (int i = 0; i < sprite_boss_explosion - sprite_explosion; ++i) {
+        const QString path = QString(":/image/IMAGES/explosion%1.png").arg(i + 1);
+        images[sprite_explosion + i] = scaled(path, QSize(explosion_box.width, explosion_box.height), dpr);
+        images[sprite_boss_explosion + i] = scaled(path, QSize(boss_explosion_box.width, boss_explosion_box.height), dpr);
+    }
+
+    SpriteAtlas& atlas = atlases[dpr];
+    atlas.build(images);
+    atlas_times.add(clock.nsecsElapsed() / 1e6);
+    return atlas;
+}
+
+
+/** Prints how much time was spent loading assets: decoding images, scaling sprites and building atlases, and how many requests were answered.
+ */
+void AssetRegistry::report() const {
+    const TimingStats& decode_times = sprites.get_decode_times();
+    const TimingStats& scale_times = sprites.get_scale_times();
+    qDebug("assets: %lld images decoded in %.2f ms (max %.2f ms), %lld sprites scaled in %.2f ms, %lld atlases built in %.2f ms, %lld lookups",
+           decode_times.total_count(), decode_times.total(), decode_times.max(),
+           scale_times.total_count(), scale_times.total(),
+           atlas_times.total_count(), atlas_times.total(),
+           sprites.get_lookups());
+}
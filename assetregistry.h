@@ -0,0 +1,50 @@
+/** @file assetregistry.h
+ * @brief Contains declarations for the AssetRegistry class, which loads every image of the app once and shares it between screens.
+ */
+
+#ifndef ASSETREGISTRY_H
+#define ASSETREGISTRY_H
+
+#include <map>
+#include <QPixmap>
+#include <QSize>
+#include <QString>
+#include "spritecache.h"
+#include "spriteatlas.h"
+#include "timingstats.h"
+
+
+
+/** @class AssetRegistry
+ * @brief Process-wide store of decoded images, scaled sprites and sprite atlases
+ *
+ * Screens and game sessions come and go, but the images they draw do not change, so they are decoded, scaled and
+ * packed the first time they are needed and kept until the app exits. Starting another game after the first one
+ * only looks them up. The registry is only used from the GUI thread.
+ */
+class AssetRegistry
+{
+public:
+    static AssetRegistry& instance();
+
+    const QPixmap& image(const QString& path);
+    const QPixmap& scaled(const QString& path, const QSize& size, qreal dpr);
+    const SpriteAtlas& game_atlas(qreal dpr);
+
+    void report() const;
+
+private:
+    AssetRegistry();
+    AssetRegistry(const AssetRegistry&);
+    AssetRegistry& operator=(const AssetRegistry&);
+
+    SpriteCache sprites;
+
+    // atlas of the gameplay sprites for each device pixel ratio. A map keeps the atlases in place when another one is added.
+    std::map<qreal, SpriteAtlas> atlases;
+    TimingStats atlas_times;
+};
+
+
+
+#endif // ASSETREGISTRY_H
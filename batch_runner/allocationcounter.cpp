@@ -0,0 +1,37 @@
+/** @file allocationcounter.cpp
+ * @brief Contains the replacement of the global operator new and delete that counts allocations per thread.
+ *
+ * The array and nothrow forms of operator new call the plain form by default, so replacing it counts them as well.
+ */
+
+#include "allocationcounter.h"
+#include <cstdlib>
+#include <new>
+
+// allocations of each thread. A counter per thread needs no synchronization, so the workers of a parallel run do not contend on it.
+static thread_local long long allocations = 0;
+
+
+/** Returns the number of allocations the calling thread has made.
+ */
+long long thread_allocations() {
+    return allocations;
+}
+
+
+/** Allocates memory with malloc and counts the allocation.
+ */
+void* operator new(std::size_t size) {
+    ++allocations;
+    void* memory = std::malloc(size > 0 ? size : 1);
+    if (memory == nullptr)
+        throw std::bad_alloc();
+    return memory;
+}
+
+
+/** Frees memory allocated by operator new.
+ */
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
@@ -0,0 +1,16 @@
+/** @file allocationcounter.h
+ * @brief Counts the heap allocations of each thread, to check that the simulation does not allocate while it runs.
+ *
+ * allocationcounter.cpp replaces the global operator new of the program it is linked into. Only the batch runner links
+ * it, and only when it is built with qmake CONFIG+=count_allocations, which defines BATCH_RUNNER_COUNT_ALLOCATIONS.
+ */
+
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+// number of times the calling thread has called operator new since it started
+long long thread_allocations();
+
+
+
+#endif // ALLOCATIONCOUNTER_H
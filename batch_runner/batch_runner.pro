@@ -0,0 +1,26 @@
+#-------------------------------------------------
+#
+# Command-line batch runner for headless playthroughs
+#
+#-------------------------------------------------
+
+TARGET = batch_runner
+TEMPLATE = app
+
+CONFIG += console thread
+CONFIG -= app_bundle qt
+
+include(../gamecore.pri)
+
+SOURCES += main.cpp \
+    workstealingpool.cpp
+
+HEADERS += workstealingpool.h
+
+# qmake CONFIG+=count_allocations links the counting operator new that --check-allocs needs. It is left out otherwise,
+# so the throughput of the other modes is measured with the allocator of the standard library.
+count_allocations {
+    DEFINES += BATCH_RUNNER_COUNT_ALLOCATIONS
+    SOURCES += allocationcounter.cpp
+    HEADERS += allocationcounter.h
+}
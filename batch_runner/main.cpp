@@ -0,0 +1,658 @@
+/** @file batch_runner/main.cpp
+ * @brief Command-line runner that plays complete headless sessions of the difficulty presets and reports throughput.
+ *
+ * Usage: batch_runner [--preset easy|medium|hard|impossible|stress|all] [--stress] [--games N] [--max-seconds S] [--seed N]
+ *                     [--record FILE] [--replay FILE] [--snapshot FILE] [--resume FILE] [--retry-soak N] [--trace FILE]
+ *                     [--monte-carlo N] [--threads T] [--scaling] [--check-allocs]
+ *
+ * Every session is played by a ScriptedPlayer as fast as the CPU allows. For each session the runner prints the outcome,
+ * the simulated time, the wall time and the number of simulation ticks per second, followed by a summary per preset
+ * that includes the peak number of live entities in each container.
+ *
+ * "all" selects the four presets of the level select screen. The stress preset, or --stress, plays a formation of
+ * thousands of enemies firing hundreds of bullets per second, to find the scaling limits of the simulation.
+ *
+ * With --seed, game n of each preset uses seed N+n, so runs can be repeated exactly. --record writes the first session
+ * played to FILE. --replay plays a recorded session back as fast as the CPU allows, without rendering, reports its
+ * speed and exits with status 1 if it did not end exactly as recorded.
+ *
+ * --snapshot plays the first session of the first selected preset until its boss battle starts, saves a snapshot of it to
+ * FILE, and checks that the session restored from FILE plays out exactly like the original. --resume restores a
+ * snapshot and plays it to the end, e.g. to start straight at a boss battle.
+ *
+ * With --retry-soak, the runner instead plays N sessions on one GameState that is reset between them, cycling through the
+ * selected presets the way Retry and Play again do in the game. It checks that memory stays flat once the first sessions
+ * have run and that resets stay fast, and exits with status 1 if either check fails.
+ *
+ * With --monte-carlo, the runner plays N sessions of each selected preset spread over all cores, or T threads, and prints
+ * the win rate, the survival time in lost sessions, how often the boss was reached and how long it took to defeat, to
+ * balance the presets against each other. --scaling plays them again on 1, 2, 4... threads and prints the speed-up.
+ *
+ * With --check-allocs, the runner plays and records the sessions on one reused GameState, as the game does, and counts
+ * the heap allocations made while ticks run with a replacement operator new. Each container is reserved for its preset
+ * when a session starts, so it exits with status 1 if any tick allocated or any spawn overflowed its container. The
+ * replacement is only linked into runners built with qmake CONFIG+=count_allocations.
+ *
+ * With --trace, the phases of the simulation are profiled and the most recent events are written to FILE as a Chrome
+ * trace once the runner finishes. Profiling is off otherwise, so it does not skew the throughput.
+ */
+
+#include "gamestate.h"
+#include "scriptedplayer.h"
+#include "timingstats.h"
+#include "profiler.h"
+#include "replay.h"
+#include "snapshot.h"
+#include "workstealingpool.h"
+#ifdef BATCH_RUNNER_COUNT_ALLOCATIONS
+#include "allocationcounter.h"
+#endif
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <thread>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+// sessions played before the memory baseline of the retry soak is taken, so that containers have grown to size
+static const int soak_warmup_cycles = 10;
+
+// largest growth of resident memory after the warm-up, and slowest 99th percentile reset, that the retry soak accepts
+static const long soak_max_growth_kb = 256;
+static const double soak_max_reset_ms = 1.0;
+
+
+/** Result of a single headless session
+ */
+struct SessionResult
+{
+    GameOutcome outcome;
+    long long ticks;
+    double wall_ms;
+    EntityCounts peak_counts;
+
+    // ticks at which the boss battle started and the boss was defeated, or -1 if the session did not get there
+    long long boss_start_tick;
+    long long boss_kill_tick;
+};
+
+
+/** Plays one session of the given preset until it is won, lost or runs out of simulated time.
+ * @param state is reset for the session, so a caller that plays many sessions can reuse its memory
+ * @param params are the difficulty settings of the session
+ * @param seed is the seed of the session's random number generator
+ * @param max_ticks is the amount of ticks after which the session is abandoned
+ * @param recording receives the session if it is not nullptr
+ * @return the outcome, length and wall time of the session
+ */
+static SessionResult play_session(GameState& state, const GameParams& params, std::uint64_t seed, long long max_ticks, Replay* recording) {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    state.reset(params, seed);
+    ScriptedPlayer player;
+    state.set_recorder(recording);
+    if (recording)
+        recording->start(state);
+
+    SessionResult result;
+    result.boss_start_tick = -1;
+    result.boss_kill_tick = -1;
+    while (state.get_outcome() == GameOutcome::Playing && state.get_ticks() < max_ticks) {
+        state.step(GameState::tick_ms, player.next_input(state));
+        if (state.is_boss_battle()) {
+            if (result.boss_start_tick < 0)
+                result.boss_start_tick = state.get_ticks();
+            if (result.boss_kill_tick < 0 && state.get_boss_health() == 0)
+                result.boss_kill_tick = state.get_ticks();
+        }
+    }
+    if (recording)
+        recording->finish(state);
+
+    result.outcome = state.get_outcome();
+    result.ticks = state.get_ticks();
+    result.peak_counts = state.get_peak_counts();
+    result.wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+
+/** Returns the resident memory of the process in kilobytes, or -1 where it cannot be measured.
+ */
+static long resident_kb() {
+#ifdef __linux__
+    long total_pages = 0;
+    long resident_pages = -1;
+    std::FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (statm == nullptr)
+        return -1;
+    if (std::fscanf(statm, "%ld %ld", &total_pages, &resident_pages) != 2)
+        resident_pages = -1;
+    std::fclose(statm);
+    return resident_pages < 0 ? -1 : resident_pages * (sysconf(_SC_PAGESIZE) / 1024);
+#else
+    return -1;
+#endif
+}
+
+
+/** Plays many sessions on a single GameState that is reset between them, and checks that memory use stays flat and resets stay fast.
+ * @param first_preset is the first difficulty that is played
+ * @param last_preset is the last difficulty that is played. Sessions cycle through the difficulties in between.
+ * @param cycles is the number of sessions
+ * @param max_ticks is the amount of ticks after which a session is abandoned
+ * @return 0 if both checks passed, 1 otherwise
+ */
+static int retry_soak(int first_preset, int last_preset, int cycles, long long max_ticks) {
+    GameState state(preset_params(first_preset));
+    ScriptedPlayer player;
+    TimingStats reset_times(cycles > 0 ? cycles : 1);
+    long baseline_kb = resident_kb();
+    long long total_ticks = 0;
+
+    for (int cycle = 0; cycle < cycles; ++cycle) {
+        const GameParams params = preset_params(first_preset + cycle % (last_preset - first_preset + 1));
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        state.reset(params);
+        reset_times.add(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+        while (state.get_outcome() == GameOutcome::Playing && state.get_ticks() < max_ticks)
+            state.step(GameState::tick_ms, player.next_input(state));
+        total_ticks += state.get_ticks();
+
+        if (cycle + 1 == soak_warmup_cycles)
+            baseline_kb = resident_kb();
+    }
+
+    const long final_kb = resident_kb();
+    const long growth_kb = baseline_kb < 0 || final_kb < 0 ? 0 : final_kb - baseline_kb;
+    const bool memory_ok = growth_kb <= soak_max_growth_kb;
+    const bool latency_ok = reset_times.percentile(99) <= soak_max_reset_ms;
+
+    std::printf("# retry soak: %d cycles, %lld ticks\n", cycles, total_ticks);
+    if (final_kb < 0)
+        std::printf("# retry soak: resident memory cannot be measured on this platform, memory check skipped\n");
+    else
+        std::printf("# retry soak: resident memory %ld kB after %d cycles, %ld kB at the end, growth %ld kB (limit %ld kB): %s\n",
+                    baseline_kb, std::min(cycles, soak_warmup_cycles), final_kb, growth_kb, soak_max_growth_kb, memory_ok ? "ok" : "FAILED");
+    std::printf("# retry soak: reset mean %.4f ms, p99 %.4f ms, max %.4f ms (p99 limit %.1f ms): %s\n",
+                reset_times.mean(), reset_times.percentile(99), reset_times.max(), soak_max_reset_ms, latency_ok ? "ok" : "FAILED");
+
+    return memory_ok && latency_ok ? 0 : 1;
+}
+
+
+#ifdef BATCH_RUNNER_COUNT_ALLOCATIONS
+/** Plays and records sessions of each selected preset on one reused GameState and counts the heap allocations made while ticks run.
+ * Resets may allocate when a preset needs larger containers than any before it; ticks must never allocate, and no spawn may overflow its container.
+ * @param first_preset is the first difficulty played
+ * @param last_preset is the last difficulty played
+ * @param sessions is the number of sessions per preset
+ * @param max_ticks is the amount of ticks after which a session is abandoned
+ * @param seed is the seed of the first session of each preset. Session n uses seed + n.
+ * @return 0 if no tick allocated and nothing overflowed, 1 otherwise
+ */
+static int check_allocations(int first_preset, int last_preset, int sessions, long long max_ticks, std::uint64_t seed) {
+    GameState state(preset_params(first_preset));
+    ScriptedPlayer player;
+    Replay recording;
+    bool ok = true;
+
+    for (int difficulty = first_preset; difficulty <= last_preset; ++difficulty) {
+        const GameParams params = preset_params(difficulty);
+        long long ticks = 0;
+        long long tick_allocations = 0;
+        EntityCounts peak = EntityCounts();
+        EntityCounts overflows = EntityCounts();
+
+        for (int session = 0; session < sessions; ++session) {
+            state.reset(params, seed + session);
+            state.set_recorder(&recording);
+            recording.start(state);
+            const long long before = thread_allocations();
+            while (state.get_outcome() == GameOutcome::Playing && state.get_ticks() < max_ticks)
+                state.step(GameState::tick_ms, player.next_input(state));
+            tick_allocations += thread_allocations() - before;
+            ticks += state.get_ticks();
+            state.set_recorder(nullptr);
+
+            const EntityCounts& counts = state.get_peak_counts();
+            peak.enemies = std::max(peak.enemies, counts.enemies);
+            peak.player_bullets = std::max(peak.player_bullets, counts.player_bullets);
+            peak.enemy_bullets = std::max(peak.enemy_bullets, counts.enemy_bullets);
+            peak.boss_bullets = std::max(peak.boss_bullets, counts.boss_bullets);
+            peak.explosions = std::max(peak.explosions, counts.explosions);
+
+            const EntityCounts& spilled = state.get_overflows();
+            overflows.enemies += spilled.enemies;
+            overflows.player_bullets += spilled.player_bullets;
+            overflows.enemy_bullets += spilled.enemy_bullets;
+            overflows.boss_bullets += spilled.boss_bullets;
+            overflows.explosions += spilled.explosions;
+        }
+
+        const EntityCounts& capacity = state.get_capacity();
+        const std::size_t overflowed = overflows.enemies + overflows.player_bullets + overflows.enemy_bullets + overflows.boss_bullets + overflows.explosions;
+        std::printf("# allocations: %s: %d sessions, %lld ticks, %lld heap allocations during ticks, %zu spawns past capacity: %s\n",
+                    preset_name(difficulty), sessions, ticks, tick_allocations, overflowed, tick_allocations == 0 && overflowed == 0 ? "ok" : "FAILED");
+        std::printf("# allocations: %s: peak / capacity: %zu/%zu enemies, %zu/%zu player bullets, %zu/%zu enemy bullets, %zu/%zu boss bullets, %zu/%zu explosions\n",
+                    preset_name(difficulty), peak.enemies, capacity.enemies, peak.player_bullets, capacity.player_bullets,
+                    peak.enemy_bullets, capacity.enemy_bullets, peak.boss_bullets, capacity.boss_bullets, peak.explosions, capacity.explosions);
+        ok = ok && tick_allocations == 0 && overflowed == 0;
+    }
+
+    return ok ? 0 : 1;
+}
+#endif
+
+
+/** Returns a printable name for the outcome of a session.
+ * @param result is the finished session
+ */
+static const char* outcome_name(const SessionResult& result) {
+    switch (result.outcome) {
+    case GameOutcome::Won: return "won";
+    case GameOutcome::Lost: return "lost";
+    default: return "timeout";
+    }
+}
+
+
+/** Plays the given number of sessions of each selected preset and prints a line per session and a summary per preset.
+ * @param first_preset is the first difficulty played
+ * @param last_preset is the last difficulty played
+ * @param games is the number of sessions per preset
+ * @param max_ticks is the amount of ticks after which a session is abandoned
+ * @param seed is the seed of the first game of each preset. Game n uses seed + n.
+ * @param record_path is the file the first session is recorded to, or nullptr
+ * @return the exit status of the runner
+ */
+static int run_presets(int first_preset, int last_preset, int games, long long max_ticks, std::uint64_t seed, const char* record_path) {
+    GameState state(preset_params(first_preset));
+    Replay recording;
+
+    std::printf("%-10s %6s %8s %10s %10s %14s\n", "preset", "game", "outcome", "sim_s", "wall_ms", "ticks_per_s");
+    for (int difficulty = first_preset; difficulty <= last_preset; ++difficulty) {
+        const GameParams params = preset_params(difficulty);
+        int won = 0;
+        int lost = 0;
+        long long total_ticks = 0;
+        double total_wall_ms = 0;
+        EntityCounts peak = EntityCounts();
+
+        for (int game = 0; game < games; ++game) {
+            const bool record = record_path != nullptr && difficulty == first_preset && game == 0;
+            const SessionResult result = play_session(state, params, seed + game, max_ticks, record ? &recording : nullptr);
+            if (record && !recording.save(record_path)) {
+                std::fprintf(stderr, "could not write replay to '%s'\n", record_path);
+                return 2;
+            }
+            const double sim_seconds = result.ticks * GameState::tick_ms / 1000.0;
+            const double ticks_per_second = result.wall_ms > 0 ? result.ticks / (result.wall_ms / 1000.0) : 0;
+
+            std::printf("%-10s %6d %8s %10.1f %10.3f %14.0f\n", preset_name(difficulty), game, outcome_name(result), sim_seconds, result.wall_ms, ticks_per_second);
+
+            won += result.outcome == GameOutcome::Won;
+            lost += result.outcome == GameOutcome::Lost;
+            total_ticks += result.ticks;
+            total_wall_ms += result.wall_ms;
+            peak.enemies = std::max(peak.enemies, result.peak_counts.enemies);
+            peak.player_bullets = std::max(peak.player_bullets, result.peak_counts.player_bullets);
+            peak.enemy_bullets = std::max(peak.enemy_bullets, result.peak_counts.enemy_bullets);
+            peak.boss_bullets = std::max(peak.boss_bullets, result.peak_counts.boss_bullets);
+            peak.explosions = std::max(peak.explosions, result.peak_counts.explosions);
+        }
+
+        std::printf("# %s: %d games, %d won, %d lost, %d timed out, %.3f ms wall per game, %.0f ticks/s\n",
+                    preset_name(difficulty), games, won, lost, games - won - lost,
+                    games > 0 ? total_wall_ms / games : 0.0,
+                    total_wall_ms > 0 ? total_ticks / (total_wall_ms / 1000.0) : 0.0);
+        std::printf("# %s: peak live entities: %zu enemies, %zu player bullets, %zu enemy bullets, %zu boss bullets, %zu explosions\n",
+                    preset_name(difficulty), peak.enemies, peak.player_bullets, peak.enemy_bullets, peak.boss_bullets, peak.explosions);
+    }
+
+    return 0;
+}
+
+
+/** Prints the mean, median and 90th percentile of a series of simulated times in seconds, or dashes if there are none.
+ */
+static void print_seconds(const TimingStats& ms) {
+    if (ms.count() == 0)
+        std::printf(" %8s %8s %8s", "-", "-", "-");
+    else
+        std::printf(" %8.1f %8.1f %8.1f", ms.mean() / 1000, ms.percentile(50) / 1000, ms.percentile(90) / 1000);
+}
+
+
+/** Plays many sessions of each selected preset on all cores and prints how each preset plays: how often it is won, how
+ * long the player survives in sessions that are lost, how often the boss is reached, and how long the boss takes to defeat.
+ * Session n of a preset uses seed + n, so the statistics do not depend on the number of threads.
+ * @param first_preset is the first difficulty played
+ * @param last_preset is the last difficulty played
+ * @param sessions is the number of sessions per preset
+ * @param max_ticks is the amount of ticks after which a session is abandoned
+ * @param seed is the seed of the first session of each preset
+ * @param threads is the number of worker threads
+ * @param scaling is true to play the sessions once for each power of two threads up to threads and print the speed-up
+ * @return the exit status of the runner
+ */
+static int run_monte_carlo(int first_preset, int last_preset, int sessions, long long max_ticks, std::uint64_t seed, int threads, bool scaling) {
+    const int presets = last_preset - first_preset + 1;
+    const std::size_t task_count = static_cast<std::size_t>(presets) * sessions;
+    std::vector<SessionResult> results(task_count);
+
+    std::vector<int> thread_counts;
+    for (int count = 1; scaling && count < threads; count *= 2)
+        thread_counts.push_back(count);
+    thread_counts.push_back(threads);
+
+    double serial_ms = 0;
+    for (int count : thread_counts) {
+        WorkStealingPool pool(count);
+
+        // one state per worker, reset for each of its sessions, so the workers do not allocate once they have warmed up
+        std::vector<std::unique_ptr<GameState>> states;
+        for (int worker = 0; worker < count; ++worker)
+            states.emplace_back(new GameState(preset_params(first_preset)));
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        pool.run(task_count, [&](std::size_t task, int worker) {
+            const int difficulty = first_preset + static_cast<int>(task / sessions);
+            results[task] = play_session(*states[worker], preset_params(difficulty), seed + task % sessions, max_ticks, nullptr);
+        });
+        const double wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        long long total_ticks = 0;
+        for (const SessionResult& result : results)
+            total_ticks += result.ticks;
+        if (count == 1)
+            serial_ms = wall_ms;
+        std::printf("# monte carlo: %zu sessions on %d threads in %.1f ms wall, %.0f sessions/s, %.0f ticks/s, %lld tasks stolen",
+                    task_count, count, wall_ms, wall_ms > 0 ? task_count / (wall_ms / 1000) : 0.0,
+                    wall_ms > 0 ? total_ticks / (wall_ms / 1000) : 0.0, pool.get_steals());
+        if (serial_ms > 0 && count > 1)
+            std::printf(", speed-up %.2fx (%.0f%% of linear)", serial_ms / wall_ms, 100 * serial_ms / wall_ms / count);
+        std::printf("\n");
+    }
+
+    std::printf("%-10s %8s %8s %8s %8s | %-26s | %8s | %-26s\n", "preset", "sessions", "won", "lost", "timeout",
+                "survival when lost: mean/p50/p90 s", "boss", "boss time to kill: mean/p50/p90 s");
+    for (int difficulty = first_preset; difficulty <= last_preset; ++difficulty) {
+        int won = 0;
+        int lost = 0;
+        int reached_boss = 0;
+        TimingStats survival_ms(sessions);
+        TimingStats boss_kill_ms(sessions);
+        for (int session = 0; session < sessions; ++session) {
+            const SessionResult& result = results[static_cast<std::size_t>(difficulty - first_preset) * sessions + session];
+            won += result.outcome == GameOutcome::Won;
+            lost += result.outcome == GameOutcome::Lost;
+            reached_boss += result.boss_start_tick >= 0;
+            if (result.outcome == GameOutcome::Lost)
+                survival_ms.add(result.ticks * GameState::tick_ms);
+            if (result.boss_kill_tick >= 0)
+                boss_kill_ms.add((result.boss_kill_tick - result.boss_start_tick) * GameState::tick_ms);
+        }
+
+        std::printf("%-10s %8d %7.1f%% %7.1f%% %7.1f%% |", preset_name(difficulty), sessions,
+                    100.0 * won / sessions, 100.0 * lost / sessions, 100.0 * (sessions - won - lost) / sessions);
+        print_seconds(survival_ms);
+        std::printf("       | %7.1f%% |", 100.0 * reached_boss / sessions);
+        print_seconds(boss_kill_ms);
+        std::printf("\n");
+    }
+
+    return 0;
+}
+
+
+/** Plays a recorded session back as fast as possible and checks that it ends exactly as it did when it was recorded.
+ * @param path is the replay file
+ * @return 0 if the session was reproduced, 1 if it was not, and 2 if the file could not be read
+ */
+static int play_replay(const char* path) {
+    Replay replay;
+    std::string error;
+    if (!replay.load(path, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 2;
+    }
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    GameState state(replay.get_params(), replay.get_seed());
+    ReplayPlayer player(&replay);
+    while (!player.is_finished() && state.get_outcome() == GameOutcome::Playing)
+        state.step(GameState::tick_ms, player);
+    const double wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    const bool matches = replay_matches(state, replay);
+    std::printf("# replay %s: seed %llu, %zu input changes, %lld ticks (%.1f s simulated) in %.3f ms wall, %.0f ticks/s\n",
+                path, static_cast<unsigned long long>(replay.get_seed()), replay.get_changes().size(), state.get_ticks(),
+                state.get_ticks() * GameState::tick_ms / 1000.0, wall_ms, wall_ms > 0 ? state.get_ticks() / (wall_ms / 1000.0) : 0.0);
+    std::printf("# replay %s: checksum %016llx, recorded %016llx: %s\n", path, static_cast<unsigned long long>(state.checksum()),
+                static_cast<unsigned long long>(replay.get_checksum()), matches ? "ok" : "MISMATCH");
+    return matches ? 0 : 1;
+}
+
+
+/** Plays the rest of a session with the ScriptedPlayer.
+ * @param state is the session
+ * @param max_ticks is the amount of ticks after which the session is abandoned
+ */
+static void play_to_end(GameState& state, long long max_ticks) {
+    ScriptedPlayer player;
+    while (state.get_outcome() == GameOutcome::Playing && state.get_ticks() < max_ticks)
+        state.step(GameState::tick_ms, player.next_input(state));
+}
+
+
+/** Saves a snapshot of a session when its boss battle starts, or halfway through if it never gets there, then checks that the session restored from the snapshot ends exactly like the original.
+ * @param params are the difficulty settings of the session
+ * @param seed is the seed of the session
+ * @param max_ticks is the amount of ticks after which the session is abandoned
+ * @param path is the snapshot file
+ * @return 0 if the restored session matched, 1 if it did not, and 2 if the snapshot could not be written
+ */
+static int check_snapshot(const GameParams& params, std::uint64_t seed, long long max_ticks, const char* path) {
+    ScriptedPlayer player;
+
+    // the first run finds the tick the snapshot is taken at
+    GameState original(params, seed);
+    long long snapshot_tick = -1;
+    while (original.get_outcome() == GameOutcome::Playing && original.get_ticks() < max_ticks) {
+        if (snapshot_tick < 0 && original.is_boss_battle())
+            snapshot_tick = original.get_ticks();
+        original.step(GameState::tick_ms, player.next_input(original));
+    }
+    if (snapshot_tick < 0)
+        snapshot_tick = original.get_ticks() / 2;
+
+    GameState saved(params, seed);
+    while (saved.get_ticks() < snapshot_tick)
+        saved.step(GameState::tick_ms, player.next_input(saved));
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (!save_snapshot_file(saved, path)) {
+        std::fprintf(stderr, "could not write snapshot to '%s'\n", path);
+        return 2;
+    }
+    const double save_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    GameState restored(preset_params(1));
+    std::string error;
+    start = std::chrono::steady_clock::now();
+    if (!load_snapshot_file(restored, path, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    const double restore_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    play_to_end(restored, max_ticks);
+
+    const bool matches = restored.get_ticks() == original.get_ticks() && restored.get_outcome() == original.get_outcome() && restored.checksum() == original.checksum();
+    std::printf("# snapshot %s: seed %llu, taken at tick %lld%s, saved in %.3f ms, restored in %.3f ms\n",
+                path, static_cast<unsigned long long>(seed), snapshot_tick, saved.is_boss_battle() ? " as the boss battle starts" : "",
+                save_ms, restore_ms);
+    std::printf("# snapshot %s: original ended at tick %lld with checksum %016llx, restored at tick %lld with %016llx: %s\n",
+                path, original.get_ticks(), static_cast<unsigned long long>(original.checksum()),
+                restored.get_ticks(), static_cast<unsigned long long>(restored.checksum()), matches ? "ok" : "MISMATCH");
+    return matches ? 0 : 1;
+}
+
+
+/** Restores a snapshot and plays it to the end.
+ * @param path is the snapshot file
+ * @param max_ticks is the amount of ticks after which the session is abandoned
+ * @return 0 if the session was played, 2 if the file could not be restored
+ */
+static int resume_snapshot(const char* path, long long max_ticks) {
+    GameState state(preset_params(1));
+    std::string error;
+    if (!load_snapshot_file(state, path, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 2;
+    }
+    const long long first_tick = state.get_ticks();
+    play_to_end(state, max_ticks);
+
+    const char* outcome = state.get_outcome() == GameOutcome::Won ? "won" : state.get_outcome() == GameOutcome::Lost ? "lost" : "timeout";
+    std::printf("# resume %s: from tick %lld to %lld, %s with %d lives and boss health %d\n",
+                path, first_tick, state.get_ticks(), outcome, state.get_lives_count(), state.get_boss_health());
+    return 0;
+}
+
+
+static void print_usage() {
+    std::printf("usage: batch_runner [--preset easy|medium|hard|impossible|stress|all] [--stress] [--games N] [--max-seconds S] [--seed N]\n"
+                "                    [--record FILE] [--replay FILE] [--snapshot FILE] [--resume FILE] [--retry-soak N] [--trace FILE]\n"
+                "                    [--monte-carlo N] [--threads T] [--scaling] [--check-allocs]\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+    int first_preset = 1;
+    int last_preset = preset_count;
+    int games = 10;
+    int max_seconds = 600;
+    int soak_cycles = 0;
+    const char* trace_path = nullptr;
+    const char* record_path = nullptr;
+    const char* replay_path = nullptr;
+    const char* snapshot_path = nullptr;
+    const char* resume_path = nullptr;
+    int monte_carlo_sessions = 0;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    bool scaling = false;
+    bool allocation_check = false;
+    bool seeded = false;
+    std::uint64_t seed = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--preset") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (std::strcmp(name, "all") != 0) {
+                first_preset = 0;
+                for (int d = 1; d <= stress_difficulty; ++d) {
+                    if (std::strcmp(name, preset_name(d)) == 0)
+                        first_preset = d;
+                }
+                if (first_preset == 0) {
+                    std::fprintf(stderr, "unknown preset '%s'\n", name);
+                    return 2;
+                }
+                last_preset = first_preset;
+            }
+        }
+        else if (std::strcmp(argv[i], "--stress") == 0) {
+            first_preset = stress_difficulty;
+            last_preset = stress_difficulty;
+        }
+        else if (std::strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            games = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--max-seconds") == 0 && i + 1 < argc) {
+            max_seconds = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--retry-soak") == 0 && i + 1 < argc) {
+            soak_cycles = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+            seeded = true;
+        }
+        else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_path = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc) {
+            snapshot_path = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--resume") == 0 && i + 1 < argc) {
+            resume_path = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--monte-carlo") == 0 && i + 1 < argc) {
+            monte_carlo_sessions = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--scaling") == 0) {
+            scaling = true;
+        }
+        else if (std::strcmp(argv[i], "--check-allocs") == 0) {
+            allocation_check = true;
+        }
+        else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+        }
+        else {
+            print_usage();
+            return std::strcmp(argv[i], "--help") == 0 ? 0 : 2;
+        }
+    }
+
+    const long long max_ticks = 1000LL * max_seconds / GameState::tick_ms;
+    Profiler::instance().set_enabled(trace_path != nullptr);
+
+    int status = 0;
+    if (replay_path)
+        status = play_replay(replay_path);
+    else if (snapshot_path)
+        status = check_snapshot(preset_params(first_preset), seeded ? seed : random_seed(), max_ticks, snapshot_path);
+    else if (resume_path)
+        status = resume_snapshot(resume_path, max_ticks);
+    else if (monte_carlo_sessions > 0)
+        status = run_monte_carlo(first_preset, last_preset, monte_carlo_sessions, max_ticks, seeded ? seed : random_seed(), threads, scaling);
+    else if (allocation_check) {
+#ifdef BATCH_RUNNER_COUNT_ALLOCATIONS
+        status = check_allocations(first_preset, last_preset, games, max_ticks, seeded ? seed : random_seed());
+#else
+        std::fprintf(stderr, "--check-allocs needs a batch runner built with qmake CONFIG+=count_allocations\n");
+        status = 2;
+#endif
+    }
+    else if (soak_cycles > 0)
+        status = retry_soak(first_preset, last_preset, soak_cycles, max_ticks);
+    else
+        status = run_presets(first_preset, last_preset, games, max_ticks, seeded ? seed : random_seed(), record_path);
+
+    if (trace_path) {
+        std::ofstream trace(trace_path);
+        Profiler::instance().write_chrome_trace(trace);
+        if (!trace) {
+            std::fprintf(stderr, "could not write trace to '%s'\n", trace_path);
+            return 2;
+        }
+        std::printf("# trace of up to %zu most recent events written to %s\n", Profiler::capacity, trace_path);
+    }
+
+    return status;
+}
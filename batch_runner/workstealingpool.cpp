@@ -0,0 +1,123 @@
+/** @file workstealingpool.cpp
+ * @brief Contains implementation of WorkStealingPool class. This class runs independent tasks on all cores.
+ */
+
+#include "workstealingpool.h"
+
+
+/** Constructor for WorkStealingPool. Starts the worker threads, which wait for run() to give them tasks.
+ * @param new_thread_count is the number of workers. At least one is started.
+ */
+WorkStealingPool::WorkStealingPool(int new_thread_count) :
+    current(nullptr),
+    generation(0),
+    running(0),
+    stopping(false),
+    steals(0)
+{
+    const int count = new_thread_count > 0 ? new_thread_count : 1;
+    for (int worker = 0; worker < count; ++worker)
+        queues.emplace_back(new WorkerQueue);
+    for (int worker = 0; worker < count; ++worker)
+        threads.emplace_back(&WorkStealingPool::worker_main, this, worker);
+}
+
+
+/** Destructor for WorkStealingPool. Stops the worker threads and waits for them to exit.
+ */
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+
+/** Runs tasks 0 to task_count - 1 on the workers and returns once all of them have finished. Tasks may run in any order
+ * and at the same time as each other, so each has to write its results to a place of its own.
+ * @param task_count is the number of tasks
+ * @param task is called once with the index of each task and of the worker running it
+ */
+void WorkStealingPool::run(std::size_t task_count, const Task& task) {
+
+    // deal the tasks out in contiguous blocks. A worker runs its block from the back, and thieves take from the front.
+    const std::size_t workers = queues.size();
+    for (std::size_t worker = 0; worker < workers; ++worker) {
+        WorkerQueue& queue = *queues[worker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.clear();
+        for (std::size_t i = task_count * worker / workers; i < task_count * (worker + 1) / workers; ++i)
+            queue.tasks.push_back(i);
+    }
+    steals = 0;
+
+    std::unique_lock<std::mutex> lock(state_mutex);
+    current = &task;
+    running = thread_count();
+    ++generation;
+    wake.notify_all();
+    finished.wait(lock, [this] { return running == 0; });
+    current = nullptr;
+}
+
+
+/** Takes the next task for a worker: the last one left in its own queue, or else the first one left in another worker's queue.
+ * @param worker is the index of the worker
+ * @param task receives the index of the task
+ * @return false once every queue is empty
+ */
+bool WorkStealingPool::take(int worker, std::size_t& task) {
+    {
+        WorkerQueue& own = *queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    // tasks are never added during a run, so a worker that finds every queue empty is done
+    const int count = thread_count();
+    for (int i = 1; i < count; ++i) {
+        WorkerQueue& victim = *queues[(worker + i) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            ++steals;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/** Runs the tasks of each run() on one worker thread until the pool is destroyed.
+ * @param worker is the index of the worker
+ */
+void WorkStealingPool::worker_main(int worker) {
+    std::uint64_t seen = 0;
+    for (;;) {
+        const Task* task = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(state_mutex);
+            wake.wait(lock, [this, seen] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+            task = current;
+        }
+
+        std::size_t index = 0;
+        while (take(worker, index))
+            (*task)(index, worker);
+
+        std::lock_guard<std::mutex> lock(state_mutex);
+        if (--running == 0)
+            finished.notify_all();
+    }
+}
@@ -0,0 +1,72 @@
+/** @file workstealingpool.h
+ * @brief Contains declarations for the WorkStealingPool class, which spreads independent tasks over a fixed set of threads.
+ */
+
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+
+/** @class WorkStealingPool
+ * @brief A fixed set of worker threads that run numbered tasks, each worker taking over tasks from the others when its own run out
+ *
+ * run() deals the tasks out to the workers in contiguous blocks. A worker takes tasks from the back of its own queue, and
+ * once that is empty it steals from the front of the other workers' queues, so workers that were dealt short tasks help
+ * the ones that were dealt long tasks and all of them finish at about the same time. Each queue has its own lock, which
+ * is only contended while stealing. Tasks are meant to take much longer than taking a lock, e.g. a whole session each.
+ */
+class WorkStealingPool
+{
+public:
+    // signature of the work done for one task. worker is the index of the thread running it, from 0 to thread_count() - 1.
+    typedef std::function<void(std::size_t task, int worker)> Task;
+
+    explicit WorkStealingPool(int new_thread_count);
+    ~WorkStealingPool();
+
+    void run(std::size_t task_count, const Task& task);
+
+    int thread_count() const { return static_cast<int>(threads.size()); }
+    long long get_steals() const { return steals; }
+
+private:
+    // tasks dealt to one worker that nobody has taken yet
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<std::size_t> tasks;
+    };
+
+    void worker_main(int worker);
+    bool take(int worker, std::size_t& task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> threads;
+
+    // the work of the current run, and how many workers are still on it. Workers wait for generation to change between runs.
+    std::mutex state_mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    const Task* current;
+    std::uint64_t generation;
+    int running;
+    bool stopping;
+
+    // tasks taken from another worker's queue during the last run
+    std::atomic<long long> steals;
+};
+
+
+
+#endif // WORKSTEALINGPOOL_H
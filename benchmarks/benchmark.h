@@ -0,0 +1,103 @@
+/** @file benchmarks/benchmark.h
+ * @brief Contains the measurement loop shared by every benchmark, and the lists of benchmarks.
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "timingstats.h"
+
+
+
+/** @struct BenchmarkOptions
+ * @brief What to run and for how long
+ */
+struct BenchmarkOptions
+{
+    // entity counts every benchmark is run at
+    std::vector<int> counts;
+
+    // only benchmarks whose name contains this are run. Empty runs all of them.
+    std::string filter;
+
+    // each benchmark and count is sampled for at least this long
+    double min_time_ms;
+};
+
+
+
+/** @struct BenchmarkResult
+ * @brief Time per call of one benchmark at one entity count. Times are in nanoseconds.
+ */
+struct BenchmarkResult
+{
+    std::string name;
+    int count;
+    long long samples;
+    int calls_per_sample;
+    double median_ns;
+    double p90_ns;
+    double min_ns;
+};
+
+
+
+// samples taken per benchmark and count, at least and at most
+static const int min_samples = 5;
+static const int max_samples = 2000;
+
+
+/** Returns true if the benchmark of the given name is selected by the filter of the options.
+ */
+inline bool benchmark_selected(const BenchmarkOptions& options, const std::string& name) {
+    return options.filter.empty() || name.find(options.filter) != std::string::npos;
+}
+
+
+/** Measures a benchmark at one entity count. Each sample runs setup() without timing it, then times calls_per_sample calls of
+ * body(). Samples are taken until min_time_ms has passed, and the time per call is reported.
+ * @param name is the name of the benchmark
+ * @param count is the entity count it runs at
+ * @param calls_per_sample is the number of calls timed together, so that very short calls are not dominated by reading the clock
+ * @param options decide how long to sample
+ * @param setup puts the entities in place
+ * @param body is the code being measured
+ */
+template <class Setup, class Body>
+BenchmarkResult measure(const std::string& name, int count, int calls_per_sample, const BenchmarkOptions& options, Setup setup, Body body) {
+    typedef std::chrono::steady_clock Clock;
+
+    TimingStats per_call(max_samples);
+    const Clock::time_point begin = Clock::now();
+    while (per_call.total_count() < max_samples
+           && (per_call.total_count() < min_samples || std::chrono::duration<double, std::milli>(Clock::now() - begin).count() < options.min_time_ms)) {
+        setup();
+        const Clock::time_point start = Clock::now();
+        for (int i = 0; i < calls_per_sample; ++i)
+            body();
+        per_call.add(std::chrono::duration<double, std::nano>(Clock::now() - start).count() / calls_per_sample);
+    }
+
+    BenchmarkResult result;
+    result.name = name;
+    result.count = count;
+    result.samples = per_call.total_count();
+    result.calls_per_sample = calls_per_sample;
+    result.median_ns = per_call.percentile(50);
+    result.p90_ns = per_call.percentile(90);
+    result.min_ns = per_call.percentile(0);
+    return result;
+}
+
+
+void run_kernel_benchmarks(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results);
+void run_hit_benchmarks(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results);
+void run_blit_benchmarks(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results);
+void run_paint_benchmarks(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results);
+
+
+
+#endif // BENCHMARK_H
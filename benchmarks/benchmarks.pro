@@ -0,0 +1,33 @@
+#-------------------------------------------------
+#
+# Benchmark suite of the gameplay kernels and the paint path
+#
+#-------------------------------------------------
+
+QT += core gui widgets
+
+TARGET = benchmarks
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../gamecore.pri)
+
+SOURCES += main.cpp \
+    kernels.cpp \
+    paint.cpp \
+    ../gameboard.cpp \
+    ../spriteatlas.cpp \
+    ../spritecache.cpp \
+    ../assetregistry.cpp
+
+HEADERS += benchmark.h \
+    ../gameboard.h \
+    ../spriteatlas.h \
+    ../spritecache.h \
+    ../assetregistry.h
+
+FORMS += ../gameboard.ui
+
+RESOURCES += ../images.qrc
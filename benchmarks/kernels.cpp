@@ -0,0 +1,186 @@
+/** @file benchmarks/kernels.cpp
+ * @brief Contains the benchmarks of the simulation kernels, the collision kernel and the software blitter. These only need the game core.
+ */
+
+#include "benchmark.h"
+#include "gamestate.h"
+#include "hitmask.h"
+#include "spriteblit.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+
+// area the enemies are spread over, and the band bullets start in. Bullets in the band stay on screen for all calls of a sample.
+static const int field_left = 30;
+static const int field_top = 40;
+static const int field_width = 620;
+static const int field_height = 340;
+static const int band_left = 200;
+static const int band_top = 200;
+static const int band_width = 300;
+static const int band_height = 150;
+
+// calls timed together. Moving bullets this many times keeps them inside the band.
+static const int kernel_calls_per_sample = 16;
+
+// number of player bullets tested against the enemies by remove_enemy. The game allows 5, but a fixed larger number shows how the formation lookup scales with enemies.
+static const int max_remove_enemy_bullets = 1000;
+
+
+/** Spreads count enemies over the field in a formation of equal columns, filled column by column from the left.
+ */
+static void spawn_formation(GameState& state, int count) {
+    const int columns = std::max(1, static_cast<int>(std::ceil(std::sqrt(count * double(field_width) / field_height))));
+    const int rows = std::max(1, (count + columns - 1) / columns);
+    state.spawn_formation(columns, rows, field_left, field_top, std::max(1, field_width / columns), std::max(1, field_height / rows), count);
+}
+
+
+/** Adds count bullets of one kind at random positions inside the given rectangle. The positions are the same on every call.
+ */
+static void spawn_bullets(GameState& state, int count, BulletKind kind, int left, int top, int width, int height) {
+    std::minstd_rand generator(count);
+    std::uniform_int_distribution<int> x(left, left + width - 1);
+    std::uniform_int_distribution<int> y(top, top + height - 1);
+    for (int i = 0; i < count; ++i)
+        state.spawn_bullet(x(generator), y(generator), kind);
+}
+
+
+/** Measures one kernel of GameState at every count of the options. The entities are placed again before each sample.
+ * @param name is the name of the benchmark
+ * @param kernel is the kernel being measured
+ * @param place puts count entities in an empty state
+ */
+template <class Place>
+static void run_kernel(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results, const char* name, GameKernel kernel, Place place) {
+    if (!benchmark_selected(options, name))
+        return;
+
+    GameState state(preset_params(1));
+    for (int count : options.counts) {
+        results.push_back(measure(name, count, kernel_calls_per_sample, options,
+                                  [&]() { state.clear_entities(); place(state, count); },
+                                  [&]() { state.run_kernel(kernel); }));
+    }
+}
+
+
+/** Measures move_enemies, move_bullets, move_boss_bullet, remove_enemy and player_hit at every count of the options.
+ * @param options are the counts and sampling time
+ * @param results receives one result per kernel and count
+ */
+void run_kernel_benchmarks(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+    run_kernel(options, results, "move_enemies", kernel_move_enemies, [](GameState& state, int count) {
+        spawn_formation(state, count);
+    });
+
+    // half of the bullets belong to the player and half to the enemies
+    run_kernel(options, results, "move_bullets", kernel_move_bullets, [](GameState& state, int count) {
+        spawn_bullets(state, count / 2, player_shot, band_left, band_top, band_width, band_height);
+        spawn_bullets(state, count - count / 2, enemy_shot, band_left, band_top, band_width, band_height);
+    });
+
+    // an equal number of each direction, as the boss fires them
+    run_kernel(options, results, "move_boss_bullet", kernel_move_boss_bullet, [](GameState& state, int count) {
+        spawn_bullets(state, count / 3, boss_shot_left, band_left, band_top, band_width, band_height);
+        spawn_bullets(state, count / 3, boss_shot_down, band_left, band_top, band_width, band_height);
+        spawn_bullets(state, count - 2 * (count / 3), boss_shot_right, band_left, band_top, band_width, band_height);
+    });
+
+    run_kernel(options, results, "remove_enemy", kernel_remove_enemy, [](GameState& state, int count) {
+        spawn_formation(state, count);
+        spawn_bullets(state, std::min(count, max_remove_enemy_bullets), player_shot, field_left, field_top, field_width, field_height);
+    });
+
+    // bullets are spread over the whole screen, and every one of them is tested against the player
+    run_kernel(options, results, "player_hit", kernel_player_hit, [](GameState& state, int count) {
+        spawn_bullets(state, count, enemy_shot, 0, 0, 700, 500);
+    });
+}
+
+
+/** Measures the collision kernel of each supported path by testing count points spread over the screen against a box the size of the player.
+ * @param options are the counts and sampling time
+ * @param results receives one result per path and count, named hit_mask/ and the path
+ */
+void run_hit_benchmarks(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+    const HitBox box = { 335, 400, 365, 420 };
+
+    const SimdPath initial_path = active_hit_path();
+    for (int path = simd_scalar; path < simd_path_count; ++path) {
+        const std::string name = std::string("hit_mask/") + simd_path_name(SimdPath(path));
+        if (!benchmark_selected(options, name) || !set_hit_path(SimdPath(path)))
+            continue;
+
+        for (int count : options.counts) {
+            std::minstd_rand generator(count);
+            std::uniform_int_distribution<int> x(0, 699);
+            std::uniform_int_distribution<int> y(0, 499);
+            std::vector<int> xs(count);
+            std::vector<int> ys(count);
+            for (int i = 0; i < count; ++i) {
+                xs[i] = x(generator);
+                ys[i] = y(generator);
+            }
+            std::vector<std::uint64_t> masks(hit_mask_words(count));
+
+            results.push_back(measure(name, count, kernel_calls_per_sample, options, [](){}, [&]() {
+                mark_points_in_box(xs.data(), ys.data(), count, box, masks.data());
+            }));
+        }
+    }
+    set_hit_path(initial_path);
+}
+
+
+/** Measures the blend kernel of each supported path by blending count bullet sized sprites into a board sized image.
+ * @param options are the counts and sampling time
+ * @param results receives one result per path and count, named blend_sprites/ and the path
+ */
+void run_blit_benchmarks(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+    const int board_width = 700;
+    const int board_height = 500;
+    const int sprite_width = 11;
+    const int sprite_height = 15;
+
+    // a round sprite: opaque in the middle, blended at the edge and transparent in the corners, like the real sprites
+    std::vector<std::uint32_t> sprite_pixels(sprite_width * sprite_height);
+    for (int y = 0; y < sprite_height; ++y) {
+        for (int x = 0; x < sprite_width; ++x) {
+            const double dx = (x - sprite_width / 2.0) / (sprite_width / 2.0);
+            const double dy = (y - sprite_height / 2.0) / (sprite_height / 2.0);
+            const double distance = std::sqrt(dx*dx + dy*dy);
+            const std::uint32_t alpha = distance < 0.7 ? 255 : distance < 1 ? static_cast<std::uint32_t>(255 * (1 - distance) / 0.3) : 0;
+            sprite_pixels[y * sprite_width + x] = alpha << 24 | (alpha * 3 / 4) << 16 | (alpha / 2) << 8 | alpha / 4;
+        }
+    }
+    const ConstImageView sprite = { sprite_pixels.data(), sprite_width, sprite_height, sprite_width };
+
+    std::vector<std::uint32_t> board_pixels(board_width * board_height, 0xff000000u);
+    const ImageView board = { board_pixels.data(), board_width, board_height, board_width };
+
+    const SimdPath initial_path = active_blit_path();
+    for (int path = simd_scalar; path < simd_path_count; ++path) {
+        const std::string name = std::string("blend_sprites/") + simd_path_name(SimdPath(path));
+        if (!benchmark_selected(options, name) || !set_blit_path(SimdPath(path)))
+            continue;
+
+        for (int count : options.counts) {
+            std::minstd_rand generator(count);
+            std::uniform_int_distribution<int> x(0, board_width - sprite_width);
+            std::uniform_int_distribution<int> y(0, board_height - sprite_height);
+            std::vector<std::pair<int,int> > positions(count);
+            for (std::pair<int,int>& position : positions)
+                position = std::make_pair(x(generator), y(generator));
+
+            results.push_back(measure(name, count, 1, options, [](){}, [&]() {
+                for (const std::pair<int,int>& position : positions)
+                    blend_image(board, position.first, position.second, sprite);
+            }));
+        }
+    }
+    set_blit_path(initial_path);
+}
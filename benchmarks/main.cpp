@@ -0,0 +1,115 @@
+/** @file benchmarks/main.cpp
+ * @brief Benchmark suite of the gameplay kernels, the software blitter and the paint path, with results as JSON.
+ *
+ * Usage: benchmarks [--counts N,N,...] [--filter NAME] [--min-time-ms T] [--json FILE]
+ *
+ * Every benchmark runs at each entity count, from a formation of 30 invaders to 100000 bullets by default. A table is
+ * printed once they finish, and with --json the results are also written to FILE so that they can be compared between
+ * releases. The board is painted offscreen, so no display is needed.
+ */
+
+#include "benchmark.h"
+#include "spriteblit.h"
+#include <QApplication>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+
+/** Reads a comma separated list of positive counts.
+ * @return false if the list is empty or a count is not a positive number
+ */
+static bool parse_counts(const char* text, std::vector<int>& counts) {
+    counts.clear();
+    std::istringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        const int count = std::atoi(item.c_str());
+        if (count <= 0)
+            return false;
+        counts.push_back(count);
+    }
+    return !counts.empty();
+}
+
+
+/** Writes the results as JSON: the options they were taken with, and one object per benchmark and count.
+ */
+static void write_json(std::ostream& out, const BenchmarkOptions& options, const std::vector<BenchmarkResult>& results) {
+    out << "{\n  \"schema\": 1,\n  \"blit_path\": \"" << simd_path_name(best_simd_path()) << "\",\n  \"hit_path\": \"" << simd_path_name(best_simd_path()) << "\",\n  \"min_time_ms\": " << options.min_time_ms << ",\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& result = results[i];
+        out << (i > 0 ? ",\n" : "\n")
+            << "    {\"name\": \"" << result.name << "\", \"count\": " << result.count
+            << ", \"samples\": " << result.samples << ", \"calls_per_sample\": " << result.calls_per_sample
+            << ", \"median_ns\": " << result.median_ns << ", \"p90_ns\": " << result.p90_ns << ", \"min_ns\": " << result.min_ns
+            << ", \"median_ns_per_entity\": " << result.median_ns / result.count << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+
+static void print_usage() {
+    std::printf("usage: benchmarks [--counts N,N,...] [--filter NAME] [--min-time-ms T] [--json FILE]\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+    // paint without a display unless a platform was chosen
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    BenchmarkOptions options;
+    options.counts = { 30, 300, 3000, 30000, 100000 };
+    options.min_time_ms = 200;
+    const char* json_path = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--counts") == 0 && i + 1 < argc) {
+            if (!parse_counts(argv[++i], options.counts)) {
+                std::fprintf(stderr, "invalid counts '%s'\n", argv[i]);
+                return 2;
+            }
+        }
+        else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            options.filter = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--min-time-ms") == 0 && i + 1 < argc) {
+            options.min_time_ms = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        }
+        else {
+            print_usage();
+            return std::strcmp(argv[i], "--help") == 0 ? 0 : 2;
+        }
+    }
+
+    std::vector<BenchmarkResult> results;
+    run_kernel_benchmarks(options, results);
+    run_hit_benchmarks(options, results);
+    run_blit_benchmarks(options, results);
+    run_paint_benchmarks(options, results);
+
+    std::printf("%-24s %8s %8s %14s %14s %14s %12s\n", "benchmark", "count", "samples", "median_ns", "p90_ns", "min_ns", "ns_per_item");
+    for (const BenchmarkResult& result : results) {
+        std::printf("%-24s %8d %8lld %14.0f %14.0f %14.0f %12.2f\n", result.name.c_str(), result.count, result.samples,
+                    result.median_ns, result.p90_ns, result.min_ns, result.median_ns / result.count);
+    }
+
+    if (json_path) {
+        std::ofstream json(json_path);
+        write_json(json, options, results);
+        if (!json) {
+            std::fprintf(stderr, "could not write results to '%s'\n", json_path);
+            return 2;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+/** @file benchmarks/paint.cpp
+ * @brief Contains the benchmark of Gameboard::paintEvent(), rendered offscreen into an image with both renderers.
+ */
+
+#include "benchmark.h"
+#include "gameboard.h"
+#include <QImage>
+#include <QPainter>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+
+/** Measures a full repaint of the board with count sprites on screen: half of them enemies and half enemy bullets, plus the
+ * player and the HUD. The board is rendered into an image, so no window is shown, and each renderer is measured.
+ * @param options are the counts and sampling time
+ * @param results receives one result per renderer and count, named paint/ and the renderer
+ */
+void run_paint_benchmarks(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+    if (!benchmark_selected(options, "paint/qpainter") && !benchmark_selected(options, "paint/blit"))
+        return;
+
+    // the board is never shown, so its timer does not step the session while it is measured
+    Gameboard board(nullptr, preset_params(1));
+    board.resize(700, 500);
+    QImage image(board.size() * board.devicePixelRatioF(), QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(board.devicePixelRatioF());
+
+    for (int blit = 0; blit < 2; ++blit) {
+        const char* name = blit ? "paint/blit" : "paint/qpainter";
+        if (!benchmark_selected(options, name))
+            continue;
+        board.set_software_blit(blit != 0);
+
+        for (int count : options.counts) {
+            GameState& state = board.get_state();
+            state.clear_entities();
+
+            std::minstd_rand generator(count);
+            std::uniform_int_distribution<int> x(20, 680);
+            std::uniform_int_distribution<int> y(80, 480);
+
+            // half of the sprites are enemies, in a formation of equal columns spread over the same area as the bullets
+            const int enemies = count / 2;
+            const int columns = std::max(1, static_cast<int>(std::ceil(std::sqrt(enemies * 660.0 / 400.0))));
+            const int rows = std::max(1, (enemies + columns - 1) / columns);
+            state.spawn_formation(columns, rows, 20, 80, std::max(1, 660 / columns), std::max(1, 400 / rows), enemies);
+            for (int i = count / 2; i < count; ++i)
+                state.spawn_bullet(x(generator), y(generator), enemy_shot);
+
+            // the first render builds the atlas and the HUD, which are cached for the rest of the session
+            board.render(&image);
+            results.push_back(measure(name, count, 1, options, [](){}, [&]() { board.render(&image); }));
+        }
+    }
+}
@@ -0,0 +1,60 @@
+/** @file entityarrays.cpp
+ * @brief Contains implementation of the structure-of-arrays containers for bullets.
+ */
+
+#include "entityarrays.h"
+
+// indexed by BulletKind: player, enemy, boss left, boss down, boss right
+const int bullet_velocity_x[bullet_kind_count] = { 0, 0, -2, 0, 2 };
+const int bullet_velocity_y[bullet_kind_count] = { -3, 3, 2, 3, 2 };
+
+
+/** Adds a bullet to the end of the arrays.
+ * @param new_x is the x coordinate of the bullet
+ * @param new_y is the y coordinate of the bullet
+ * @param new_kind is the type of the bullet, which decides its velocity
+ */
+void BulletArray::push(int new_x, int new_y, BulletKind new_kind) {
+    x.push_back(new_x);
+    y.push_back(new_y);
+    vx.push_back(bullet_velocity_x[new_kind]);
+    vy.push_back(bullet_velocity_y[new_kind]);
+    kind.push_back(new_kind);
+}
+
+
+/** Makes room for the given number of bullets, so that pushing up to that many does not allocate.
+ * @param count is the number of bullets
+ */
+void BulletArray::reserve(std::size_t count) {
+    x.reserve(count);
+    y.reserve(count);
+    vx.reserve(count);
+    vy.reserve(count);
+    kind.reserve(count);
+}
+
+
+/** Removes all bullets.
+ */
+void BulletArray::clear() {
+    x.clear();
+    y.clear();
+    vx.clear();
+    vy.clear();
+    kind.clear();
+}
+
+
+/** Moves every bullet by its velocity.
+ */
+void BulletArray::integrate() {
+    int* px = x.data();
+    int* py = y.data();
+    const int* pvx = vx.data();
+    const int* pvy = vy.data();
+    for (std::size_t i = 0, n = x.size(); i < n; ++i) {
+        px[i] += pvx[i];
+        py[i] += pvy[i];
+    }
+}
@@ -0,0 +1,92 @@
+/** @file entityarrays.h
+ * @brief Contains declarations for the structure-of-arrays containers that store bullets.
+ *
+ * Each coordinate is kept in its own contiguous array, so the per-tick movement and collision loops run over plain
+ * int arrays that the compiler can vectorize.
+ */
+
+#ifndef ENTITYARRAYS_H
+#define ENTITYARRAYS_H
+
+#include <vector>
+#include <cstddef>
+
+
+
+/** @enum BulletKind
+ * @brief Type of a bullet. The kind decides the bullet's velocity and the image it is drawn with.
+ */
+enum BulletKind
+{
+    player_shot,        // moves straight up
+    enemy_shot,         // moves straight down
+    boss_shot_left,     // moves down at a 45 degree angle to the left
+    boss_shot_down,     // moves straight down
+    boss_shot_right,    // moves down at a 45 degree angle to the right
+    bullet_kind_count
+};
+
+// distance that each kind of bullet moves per bullet step
+extern const int bullet_velocity_x[bullet_kind_count];
+extern const int bullet_velocity_y[bullet_kind_count];
+
+
+
+/** @struct BulletArray
+ * @brief Positions, velocities and kinds of a group of bullets, stored as separate arrays
+ *
+ * Bullet i is at (x[i], y[i]), moves by (vx[i], vy[i]) per bullet step and is of type kind[i]. The velocity is copied
+ * from the per-kind tables when the bullet is fired, so moving bullets needs no lookup.
+ */
+struct BulletArray
+{
+    std::vector<int> x;
+    std::vector<int> y;
+    std::vector<int> vx;
+    std::vector<int> vy;
+    std::vector<unsigned char> kind;
+
+    std::size_t size() const { return x.size(); }
+    bool empty() const { return x.empty(); }
+    std::size_t capacity() const { return x.capacity(); }
+    void push(int new_x, int new_y, BulletKind new_kind);
+    void reserve(std::size_t count);
+    void clear();
+    void integrate();
+
+    template <class Dead>
+    std::size_t remove_if(Dead dead);
+};
+
+
+
+/** Removes every bullet for which dead(i) is true in a single compaction pass, keeping the order of the remaining bullets.
+ * @param dead is called once with the index of each bullet, in order. It may read bullet i, which has not been moved yet.
+ * @return the number of bullets that were removed
+ */
+template <class Dead>
+std::size_t BulletArray::remove_if(Dead dead) {
+    const std::size_t n = x.size();
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (dead(i))
+            continue;
+
+        x[kept] = x[i];
+        y[kept] = y[i];
+        vx[kept] = vx[i];
+        vy[kept] = vy[i];
+        kind[kept] = kind[i];
+        ++kept;
+    }
+
+    x.resize(kept);
+    y.resize(kept);
+    vx.resize(kept);
+    vy.resize(kept);
+    kind.resize(kept);
+    return n - kept;
+}
+
+
+#endif // ENTITYARRAYS_H
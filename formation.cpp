@@ -0,0 +1,250 @@
+/** @file formation.cpp
+ * @brief Contains implementation of Formation class. This class keeps the invaders as a bitmask over a moving grid.
+ */
+
+#include "formation.h"
+#include <algorithm>
+
+#if defined(__GNUC__)
+#define FORMATION_BUILTIN_BITSCAN
+#endif
+
+
+/** Returns the index of the lowest set bit of a word that is not 0.
+ */
+static int lowest_bit(std::uint64_t word) {
+#ifdef FORMATION_BUILTIN_BITSCAN
+    return __builtin_ctzll(word);
+#else
+    int bit = 0;
+    while ((word & 1) == 0) {
+        word >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+
+/** Returns the index of the highest set bit of a word that is not 0.
+ */
+static int highest_bit(std::uint64_t word) {
+#ifdef FORMATION_BUILTIN_BITSCAN
+    return 63 - __builtin_clzll(word);
+#else
+    int bit = 63;
+    while ((word >> bit) == 0)
+        --bit;
+    return bit;
+#endif
+}
+
+
+/** Constructor for Formation. The formation is empty until it is reset.
+ */
+Formation::Formation() :
+    columns(0),
+    rows(0),
+    left(0),
+    top(0),
+    pitch_x(1),
+    pitch_y(1),
+    words_per_row(0),
+    alive(0)
+{
+}
+
+
+/** Places a new formation and brings the first count invaders to life, column by column from the left.
+ * @param new_columns is the number of columns
+ * @param new_rows is the number of rows
+ * @param new_left is the x coordinate of the first column
+ * @param new_top is the y coordinate of the first row
+ * @param new_pitch_x is the distance between neighbouring columns, at least 1
+ * @param new_pitch_y is the distance between neighbouring rows, at least 1
+ * @param count is the number of live invaders. It is at most columns * rows.
+ */
+void Formation::reset(int new_columns, int new_rows, int new_left, int new_top, int new_pitch_x, int new_pitch_y, std::size_t count) {
+    columns = std::max(new_columns, 0);
+    rows = std::max(new_rows, 0);
+    left = new_left;
+    top = new_top;
+    pitch_x = std::max(new_pitch_x, 1);
+    pitch_y = std::max(new_pitch_y, 1);
+    words_per_row = (columns + 63) / 64;
+    row_masks.assign(static_cast<std::size_t>(rows) * words_per_row, 0);
+
+    count = std::min(count, static_cast<std::size_t>(columns) * rows);
+    for (std::size_t i = 0; i < count; ++i) {
+        const int column = static_cast<int>(i / rows);
+        const int row = static_cast<int>(i % rows);
+        row_masks[row * words_per_row + column / 64] |= std::uint64_t(1) << (column % 64);
+    }
+    recount();
+}
+
+
+/** Makes room for a formation of the given size, so that resetting to it does not allocate.
+ */
+void Formation::reserve(int max_columns, int max_rows) {
+    const std::size_t words = (std::max(max_columns, 0) + 63) / 64;
+    row_masks.reserve(words * std::max(max_rows, 0));
+    column_counts.reserve(std::max(max_columns, 0));
+    row_counts.reserve(std::max(max_rows, 0));
+    live_columns.reserve(words);
+    live_rows.reserve((std::max(max_rows, 0) + 63) / 64);
+}
+
+
+/** Removes every invader and the grid they were in.
+ */
+void Formation::clear() {
+    reset(0, 0, 0, 0, 1, 1, 0);
+}
+
+
+/** Rebuilds the counts and the masks of live columns and rows from the masks of the rows.
+ */
+void Formation::recount() {
+    column_counts.assign(columns, 0);
+    row_counts.assign(rows, 0);
+    live_columns.assign(words_per_row, 0);
+    live_rows.assign((rows + 63) / 64, 0);
+    alive = 0;
+
+    for (int row = 0; row < rows; ++row) {
+        for (int word = 0; word < words_per_row; ++word) {
+            std::uint64_t bits = row_masks[row * words_per_row + word];
+            live_columns[word] |= bits;
+            while (bits != 0) {
+                ++column_counts[word * 64 + lowest_bit(bits)];
+                ++row_counts[row];
+                ++alive;
+                bits &= bits - 1;
+            }
+        }
+        if (row_counts[row] > 0)
+            live_rows[row / 64] |= std::uint64_t(1) << (row % 64);
+    }
+}
+
+
+/** Returns true if the invader in the given cell is alive. Cells outside the grid are never alive.
+ */
+bool Formation::is_alive(int column, int row) const {
+    if (column < 0 || column >= columns || row < 0 || row >= rows)
+        return false;
+    return (row_masks[row * words_per_row + column / 64] >> (column % 64)) & 1;
+}
+
+
+/** Kills the invader in the given cell, if it is alive, and updates the counts and masks of its column and row.
+ */
+void Formation::kill(int column, int row) {
+    if (!is_alive(column, row))
+        return;
+
+    row_masks[row * words_per_row + column / 64] &= ~(std::uint64_t(1) << (column % 64));
+    --alive;
+    if (--column_counts[column] == 0)
+        live_columns[column / 64] &= ~(std::uint64_t(1) << (column % 64));
+    if (--row_counts[row] == 0)
+        live_rows[row / 64] &= ~(std::uint64_t(1) << (row % 64));
+}
+
+
+/** Returns the index of the lowest set bit of a mask, or -1 if no bit is set.
+ */
+int Formation::first_bit(const std::vector<std::uint64_t>& mask) {
+    for (std::size_t word = 0; word < mask.size(); ++word) {
+        if (mask[word] != 0)
+            return static_cast<int>(word * 64) + lowest_bit(mask[word]);
+    }
+    return -1;
+}
+
+
+/** Returns the index of the highest set bit of a mask, or -1 if no bit is set.
+ */
+int Formation::last_bit(const std::vector<std::uint64_t>& mask) {
+    for (std::size_t word = mask.size(); word-- > 0;) {
+        if (mask[word] != 0)
+            return static_cast<int>(word * 64) + highest_bit(mask[word]);
+    }
+    return -1;
+}
+
+
+/** Returns the leftmost column with a live invader, or -1 if there is none.
+ */
+int Formation::first_column() const {
+    return first_bit(live_columns);
+}
+
+
+/** Returns the rightmost column with a live invader, or -1 if there is none.
+ */
+int Formation::last_column() const {
+    return last_bit(live_columns);
+}
+
+
+/** Returns the lowest row with a live invader, or -1 if there is none.
+ */
+int Formation::last_row() const {
+    return last_bit(live_rows);
+}
+
+
+/** Finds the live invader with the given number, counting column by column from the left and top to bottom within a column. Whole columns are skipped by their counts.
+ * @param n is the number of the invader, less than size()
+ * @param column receives its column
+ * @param row receives its row
+ */
+void Formation::find(std::size_t n, int& column, int& row) const {
+    column = first_column();
+    while (n >= static_cast<std::size_t>(column_counts[column])) {
+        n -= column_counts[column];
+        ++column;
+    }
+
+    const std::uint64_t bit = std::uint64_t(1) << (column % 64);
+    const std::uint64_t* word = row_masks.data() + column / 64;
+    for (row = 0; ; ++row, word += words_per_row) {
+        if ((*word & bit) && n-- == 0)
+            return;
+    }
+}
+
+
+/** Replaces the formation with one stored in a snapshot.
+ * @param masks are the masks of the rows, words_per_row words each
+ * @param mask_count is the number of words in masks
+ * @return false if the masks do not match the size of the grid or have bits set past its last column
+ */
+bool Formation::restore(int new_columns, int new_rows, int new_left, int new_top, int new_pitch_x, int new_pitch_y, const std::uint64_t* masks, std::size_t mask_count) {
+    if (new_columns < 0 || new_rows < 0 || new_pitch_x < 1 || new_pitch_y < 1)
+        return false;
+    // rounded up without adding to the width first, which could overflow
+    const int new_words_per_row = new_columns / 64 + (new_columns % 64 != 0 ? 1 : 0);
+    if (mask_count != static_cast<std::size_t>(new_rows) * new_words_per_row)
+        return false;
+
+    // the last word of each row may only have bits for columns that exist
+    const std::uint64_t last_word = new_columns % 64 == 0 ? ~std::uint64_t(0) : (std::uint64_t(1) << (new_columns % 64)) - 1;
+    for (int row = 0; row < new_rows; ++row) {
+        if (new_words_per_row > 0 && (masks[(row + 1) * new_words_per_row - 1] & ~last_word) != 0)
+            return false;
+    }
+
+    columns = new_columns;
+    rows = new_rows;
+    left = new_left;
+    top = new_top;
+    pitch_x = new_pitch_x;
+    pitch_y = new_pitch_y;
+    words_per_row = new_words_per_row;
+    row_masks.assign(masks, masks + mask_count);
+    recount();
+    return true;
+}
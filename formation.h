@@ -0,0 +1,157 @@
+/** @file formation.h
+ * @brief Contains declarations for the Formation class, which stores the invaders as a grid with a bitmask of the live ones.
+ */
+
+#ifndef FORMATION_H
+#define FORMATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+
+/** @class Formation
+ * @brief The invaders: a grid of columns and rows placed at an origin, and which cells of it are still alive
+ *
+ * Every invader is at (left + column * pitch_x, top + row * pitch_y), so moving the formation only moves its origin.
+ * Each row has a bitmask of its live columns, and masks of the columns and rows that still have a live invader are kept
+ * up to date as invaders are killed, so the leftmost and rightmost live column and the lowest live row are found with a
+ * bit scan. Invaders are numbered column by column from the left, top to bottom within a column.
+ */
+class Formation
+{
+public:
+    Formation();
+
+    void reset(int new_columns, int new_rows, int new_left, int new_top, int new_pitch_x, int new_pitch_y, std::size_t count);
+    void reserve(int max_columns, int max_rows);
+    void clear();
+    void move(int dx, int dy) { left += dx; top += dy; }
+
+    std::size_t size() const { return alive; }
+    bool empty() const { return alive == 0; }
+    bool is_alive(int column, int row) const;
+    void kill(int column, int row);
+
+    int column_x(int column) const { return left + column * pitch_x; }
+    int row_y(int row) const { return top + row * pitch_y; }
+    int first_column() const;
+    int last_column() const;
+    int last_row() const;
+    void find(std::size_t n, int& column, int& row) const;
+
+    template <class Visit>
+    void for_each(Visit visit) const;
+    template <class Visit>
+    void for_each_column(Visit visit) const;
+    template <class Visit>
+    void for_each_near(int x_low, int x_high, int y_low, int y_high, Visit visit) const;
+
+    // layout and raw masks, for checksums and snapshots
+    int get_columns() const { return columns; }
+    int get_rows() const { return rows; }
+    int get_left() const { return left; }
+    int get_top() const { return top; }
+    int get_pitch_x() const { return pitch_x; }
+    int get_pitch_y() const { return pitch_y; }
+    const std::vector<std::uint64_t>& get_row_masks() const { return row_masks; }
+    bool restore(int new_columns, int new_rows, int new_left, int new_top, int new_pitch_x, int new_pitch_y, const std::uint64_t* masks, std::size_t mask_count);
+
+    // number of 64-bit words in the mask of one row
+    int get_words_per_row() const { return words_per_row; }
+
+private:
+    void recount();
+    static int first_bit(const std::vector<std::uint64_t>& mask);
+    static int last_bit(const std::vector<std::uint64_t>& mask);
+
+    int columns;
+    int rows;
+    int left;
+    int top;
+    int pitch_x;
+    int pitch_y;
+    int words_per_row;
+
+    // bit c of row r is set if the invader in column c of row r is alive. Row r starts at word r * words_per_row.
+    std::vector<std::uint64_t> row_masks;
+
+    // live invaders per column and per row, and a bit for each column and row that has any
+    std::vector<int> column_counts;
+    std::vector<int> row_counts;
+    std::vector<std::uint64_t> live_columns;
+    std::vector<std::uint64_t> live_rows;
+    std::size_t alive;
+};
+
+
+
+/** Calls visit(x, y) with the position of every live invader, row by row from the top and from the left within a row.
+ * Only the set bits of each row mask are visited, so the cost follows the number of live invaders and not the size of the grid.
+ */
+template <class Visit>
+void Formation::for_each(Visit visit) const {
+    const std::uint64_t* word = row_masks.data();
+    for (int row = 0; row < rows; ++row, word += words_per_row) {
+        if (row_counts[row] == 0)
+            continue;
+        const int y = row_y(row);
+        for (int index = 0; index < words_per_row; ++index) {
+            for (std::uint64_t bits = word[index]; bits != 0; bits &= bits - 1) {
+#if defined(__GNUC__)
+                const int bit = __builtin_ctzll(bits);
+#else
+                int bit = 0;
+                while (((bits >> bit) & 1) == 0)
+                    ++bit;
+#endif
+                visit(column_x(index * 64 + bit), y);
+            }
+        }
+    }
+}
+
+
+/** Calls visit(x) with the x coordinate of every column that has a live invader, from the left.
+ */
+template <class Visit>
+void Formation::for_each_column(Visit visit) const {
+    for (int column = first_column(); column >= 0 && column < columns; ++column) {
+        if (column_counts[column] != 0)
+            visit(column_x(column));
+    }
+}
+
+
+/** Calls visit(column, row) for every live invader whose position is inside the given box, edges included, column by column from the left. Only the cells that overlap the box are looked at.
+ */
+template <class Visit>
+void Formation::for_each_near(int x_low, int x_high, int y_low, int y_high, Visit visit) const {
+    if (alive == 0)
+        return;
+
+    // cells whose position is in the box, rounding the low edges up and the high edges down
+    const auto floor_div = [](int a, int b) { return a >= 0 ? a / b : -((-a + b - 1) / b); };
+    int first = -floor_div(left - x_low, pitch_x);
+    int last = floor_div(x_high - left, pitch_x);
+    int top_row = -floor_div(top - y_low, pitch_y);
+    int bottom_row = floor_div(y_high - top, pitch_y);
+    if (first < 0) first = 0;
+    if (last >= columns) last = columns - 1;
+    if (top_row < 0) top_row = 0;
+    if (bottom_row >= rows) bottom_row = rows - 1;
+
+    for (int column = first; column <= last; ++column) {
+        if (column_counts[column] == 0)
+            continue;
+        for (int row = top_row; row <= bottom_row; ++row) {
+            if (is_alive(column, row))
+                visit(column, row);
+        }
+    }
+}
+
+
+
+#endif // FORMATION_H
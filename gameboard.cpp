@@ -1,10 +1,11 @@
 /** @file gameboard.cpp
- * @brief Contains implementation of Gameboard class. This class contains everything needed to play the "game" part of the app.
+ * @brief Contains implementation of Gameboard class. This class displays the "game" part of the app and passes the player's input to the simulation.
  */
 
 #include "gameboard.h"
 #include "ui_gameboard.h"
 #include "mainwindow.h"
+#include "assetregistry.h"
 #include <QLabel>
 #include <QHBoxLayout>
 #include <QVBoxLayout>
@@ -13,194 +14,195 @@
 #include <vector>
 #include <QKeyEvent>
 #include <QShowEvent>
-#include <random>
-#include <chrono>
+#include <algorithm>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QtGlobal>
+#include <QRegion>
+#include <QPaintEvent>
+#include <QtMath>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFont>
+#include <sstream>
 
-// create random number generator to determine enemy firing
-unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-std::default_random_engine generator (seed);
 
+// largest number of changed areas that are repainted on their own. Beyond it the whole board is repainted.
+static const size_t max_dirty_rects = 48;
 
-/** Contructor for the main gameboard. Loads images and initializes all timers and variables necessary to make the game work.
+
+/** Contructor for the main gameboard. Creates the simulation with the given difficulty settings and starts it. Later sessions are started with reset(). The images are taken from the AssetRegistry when the board is first painted, once the pixel ratio of its screen is known.
  * @param parent is the parent of the gameboard
- * @param new_enemy_speed is the speed of enemy movement
- * @param new_enemy_fire_rate is the rate that the enemies fire bullets
- * @param new_boss_speed is the speed of boss movement
- * @param new_boss_fire_rate is the rate that the boss fires bullets
- * @param new_boss_health is the amount of hits requires to defeat the boss
+ * @param params are the difficulty settings: speed and fire rate of enemies and boss, and the amount of hits required to defeat the boss
  */
-Gameboard::Gameboard(QWidget *parent, int new_enemy_speed, int new_enemy_fire_rate, int new_boss_speed, int new_boss_fire_rate, int new_boss_health) :
+Gameboard::Gameboard(QWidget *parent, const GameParams& params) :
     QWidget(parent),
-    ui(new Ui::Gameboard)
+    ui(new Ui::Gameboard),
+    state(params),
+    first_frame_ms(-1),
+    dropped_frames(0),
+    recording_active(true),
+    replaying(false),
+    atlas_dpr(0),
+    profile_overlay(false),
+    trace_recording(false),
+    software_blit(qgetenv("SPACE_INVADERS_RENDERER") == "blit"),
+    hud_lives(0),
+    hud_boss_battle(false),
+    hud_boss_health(-1)
 {
+    setup_clock.start();
+    input_clock.start();
     ui->setupUi(this);
+    state.set_recorder(&recording);
+    recording.start(state);
+
+    // starts timer that steps the simulation and requests a repaint once per display frame. The simulation is advanced by the real time that passed since the previous step.
+    const qreal refresh_rate = QGuiApplication::primaryScreen() ? QGuiApplication::primaryScreen()->refreshRate() : 60;
+    frame_budget_ms = 1000.0 / (refresh_rate > 0 ? refresh_rate : 60);
+    clock.start();
+    frame_timer_id = startTimer(qMax(1, qRound(frame_budget_ms)), Qt::PreciseTimer);
+}
 
-    // set enemy speed and fire rate
-    enemy_speed = new_enemy_speed;
-    enemy_fire_rate = new_enemy_fire_rate;
 
-    // set boss speed and fire rate
-    boss_speed = new_boss_speed;
-    boss_fire_rate = new_boss_fire_rate;
+/** Starts a new session on this board with the given difficulty settings. The board, its timer and its sprites are reused, so starting another game does not allocate or load anything.
+ * @param params are the difficulty settings: speed and fire rate of enemies and boss, and the amount of hits required to defeat the boss
+ */
+void Gameboard::reset(const GameParams& params) {
+    setup_clock.start();
+    state.reset(params);
+    replaying = false;
+    recording_active = true;
+    state.set_recorder(&recording);
+    recording.start(state);
+    begin_session();
+}
+
 
-    // initialize positions of enemies. Positions stored as std::pair<int,int> with x and y coordinates.
-    for (int i = 30; i < 500; i += 50) {
-        for (int j = 40; j < 150; j += 50) {
-            enemy_positions.push_back(std::make_pair(i,j));
-        }
+/** Plays a recorded session back at normal speed. The keyboard is ignored until the replay ends, and whether it ended exactly like the recording is printed.
+ * @param new_replay is the recording, which is copied
+ */
+void Gameboard::start_replay(const Replay& new_replay) {
+    setup_clock.start();
+    replay = new_replay;
+    ::start_replay(state, replay);
+    replaying = true;
+    recording_active = false;
+    replay_player = ReplayPlayer(&replay);
+    state.set_recorder(nullptr);
+    begin_session();
+}
+
+
+/** Continues a session from a snapshot file, e.g. one saved with F5. The file is mapped into memory and the session is restored from it in place. A restored session is not recorded, because a replay has to start from the beginning of a session.
+ * @param path is the snapshot file
+ * @return true if the session was restored. Otherwise the current session goes on.
+ */
+bool Gameboard::restore_snapshot(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning("cannot open %s", qPrintable(path));
+        return false;
+    }
+    const uchar* data = file.size() > 0 ? file.map(0, file.size()) : nullptr;
+    if (data == nullptr) {
+        qWarning("cannot map %s", qPrintable(path));
+        return false;
     }
 
-    // load all images
-    invader = QPixmap(":/image/IMAGES/invader.png");
-    spaceship = QPixmap(":/image/IMAGES/spaceship.png");
-    player_bullet = QPixmap(":/image/IMAGES/player_bullet.png");
-    enemy_bullet = QPixmap(":/image/IMAGES/enemy_bullet.png");
-    boss_text = QPixmap(":/image/IMAGES/boss_message.png");
-    win_text = QPixmap(":/image/IMAGES/win_message.png");
-    boss = QPixmap(":/image/IMAGES/boss.png");
-    lives_remaining_message = QPixmap(":/image/IMAGES/lives_remaining.png");
-    boss_health_message = QPixmap(":/image/IMAGES/boss_health.png");
-    enemy_bullet_left = QPixmap(":/image/IMAGES/enemy_bullet_left.png");
-    enemy_bullet_right = QPixmap(":/image/IMAGES/enemy_bullet_right.png");
-    QPixmap explosion1(":/image/IMAGES/explosion1.png");
-    QPixmap explosion2(":/image/IMAGES/explosion2.png");
-    QPixmap explosion3(":/image/IMAGES/explosion3.png");
-    QPixmap explosion4(":/image/IMAGES/explosion4.png");
-    QPixmap explosion5(":/image/IMAGES/explosion5.png");
-    QPixmap explosion6(":/image/IMAGES/explosion6.png");
-    QPixmap explosion7(":/image/IMAGES/explosion7.png");
-    QPixmap explosion8(":/image/IMAGES/explosion8.png");
-    QPixmap explosion9(":/image/IMAGES/explosion9.png");
-    QPixmap explosion10(":/image/IMAGES/explosion10.png");
-    QPixmap explosion11(":/image/IMAGES/explosion11.png");
-    QPixmap explosion12(":/image/IMAGES/explosion12.png");
-    QPixmap explosion13(":/image/IMAGES/explosion13.png");
-    QPixmap explosion14(":/image/IMAGES/explosion14.png");
-
-    // add each frame of explosion animation to vector
-    explosions.push_back(explosion1);
-    explosions.push_back(explosion2);
-    explosions.push_back(explosion3);
-    explosions.push_back(explosion4);
-    explosions.push_back(explosion5);
-    explosions.push_back(explosion6);
-    explosions.push_back(explosion7);
-    explosions.push_back(explosion8);
-    explosions.push_back(explosion9);
-    explosions.push_back(explosion10);
-    explosions.push_back(explosion11);
-    explosions.push_back(explosion12);
-    explosions.push_back(explosion13);
-    explosions.push_back(explosion14);
-
-   // enemy_positions.push_back(std::make_pair(30,40));
-
-    // set initial player position
-    player_position = std::make_pair(350,410);
-
-    // set initial boss position
-    boss_position = std::make_pair(250,40);
-
-    // set initial lives
-    lives_count = 3;
-
-    // enemies initially moving right
-    moving_right = true;
-
-    // player is initially alive
-    alive = true;
-
-    // boss initially moves right
-    boss_moving_right = true;
-
-    // boss battle has not occurred yet, so set variables related to boss to false
-    boss_message = false;
-    start_boss_battle = false;
-    boss_alive = false;
-    win_message = false;
-
-    // set initial boss health
-    boss_health = new_boss_health;
-    total_boss_health = new_boss_health;
-
-    // starts timer for smooth left/right movement of player
-    startTimer(15);
-
-    // timer only allows player to shoot once per 300 milliseconds
-    shoot_timer = new QTimer(this);
-    shoot_timer->setInterval(300);
-    shoot_timer->setSingleShot(true);
-
-    // timer creates delay between last death and game over screen
-    game_over_timer = new QTimer(this);
-    game_over_timer->setInterval(2000);
-    game_over_timer->setSingleShot(true);
-    QObject::connect(game_over_timer,SIGNAL(timeout()), this, SLOT(emit_game_over()));
-
-    // timer determines how quickly enemies move
-    enemy_timer = new QTimer(this);
-    enemy_timer->setInterval(enemy_speed);
-    enemy_timer->start();
-    QObject::connect(enemy_timer,SIGNAL(timeout()), this, SLOT(move_enemies()));
-
-    // timer determines speed of bullets and collision detection
-    bullet_timer = new QTimer(this);
-    bullet_timer->setInterval(10);
-    bullet_timer->start();
-    QObject::connect(bullet_timer,SIGNAL(timeout()), this, SLOT(move_bullets()));
-    QObject::connect(bullet_timer,SIGNAL(timeout()), this, SLOT(remove_enemy()));
-    QObject::connect(bullet_timer,SIGNAL(timeout()),this, SLOT(player_hit()));
-    QObject::connect(bullet_timer,SIGNAL(timeout()),this,SLOT(move_boss_bullet()));
-    QObject::connect(bullet_timer,SIGNAL(timeout()),this,SLOT(player_hit_boss()));
-    QObject::connect(bullet_timer,SIGNAL(timeout()),this,SLOT(boss_hit()));
-
-    // timer used to create explosion animation
-    explosion_timer = new QTimer(this);
-    explosion_timer->setInterval(50);
-    explosion_timer->start();
-    QObject::connect(explosion_timer,SIGNAL(timeout()),this,SLOT(draw_explosion()));
-
-    // timer used to create boss explosion animation
-    boss_explosion_timer = new QTimer(this);
-    boss_explosion_timer->setInterval(100);
-    QObject::connect(boss_explosion_timer, SIGNAL(timeout()),this,SLOT(draw_boss_explosion()));
-
-    // timer determines speed of boss movement
-    boss_move_timer = new QTimer (this);
-    boss_move_timer->setInterval(boss_speed);
-    QObject::connect(boss_move_timer,SIGNAL(timeout()),this,SLOT(move_boss()));
-
-    // timer determines how long player takes to respawn after dying
-    respawn_timer = new QTimer(this);
-    respawn_timer->setInterval(2000);
-    QObject::connect(respawn_timer,SIGNAL(timeout()), this, SLOT(respawn()));
-
-    // timer determines how long "boss battle" message remains on screen. Also creates a delay between defeating last enemy and appearance of boss battle message.
-    boss_battle_timer = new QTimer(this);
-    boss_battle_timer->setInterval(2000);
-    QObject::connect(boss_battle_timer,SIGNAL(timeout()),this, SLOT(boss_battle_message()));
-
-    // timer determines how quickly enemies fire bullets
-    enemy_fire_bullet_timer = new QTimer(this);
-    enemy_fire_bullet_timer->setInterval(enemy_fire_rate);
-    enemy_fire_bullet_timer->start();
-    QObject::connect(enemy_fire_bullet_timer,SIGNAL(timeout()), this, SLOT(enemy_fire_bullet()));
-
-    // timer determines how quickly boss fires bullets
-    boss_fire_rate_timer = new QTimer(this);
-    boss_fire_rate_timer->setInterval(boss_fire_rate);
-    QObject::connect(boss_fire_rate_timer,SIGNAL(timeout()),this,SLOT(boss_fire_bullet()));
-
-    // timer determines how long "you win" message remains on screen. Also creates delay between defeating boss and appearance of win message.
-    win_message_timer = new QTimer(this);
-    win_message_timer->setInterval(2000);
-    QObject::connect(win_message_timer,SIGNAL(timeout()),this,SLOT(win_message_appear()));
-
-    // display game over or win screen when the corresponding signal is emitted
-    QObject::connect(this,SIGNAL(game_over()),parent,SLOT(game_over_screen()));
-    QObject::connect(this,SIGNAL(win_game()),parent,SLOT(win_screen()));
+    std::string error;
+    const bool restored = state.restore_snapshot(data, static_cast<std::size_t>(file.size()), error);
+    file.unmap(const_cast<uchar*>(data));
+    if (!restored) {
+        qWarning("%s: %s", qPrintable(path), error.c_str());
+        return false;
+    }
+
+    setup_clock.start();
+    replaying = false;
+    recording_active = false;
+    state.set_recorder(nullptr);
+    begin_session();
+    qDebug("session restored from %s at %.1f s", qPrintable(path), state.get_ticks() * GameState::tick_ms / 1000.0);
+    return true;
+}
+
+
+/** Saves a snapshot of the session to space_invaders_quicksave.siss in the working directory. F9 restores it, and so does starting the game with --resume.
+ */
+void Gameboard::save_snapshot() {
+    state.save_snapshot(snapshot_buffer);
+    const QString path = QDir::current().filePath("space_invaders_quicksave.siss");
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(reinterpret_cast<const char*>(snapshot_buffer.data()), snapshot_buffer.size()) < 0) {
+        qWarning("could not write snapshot to %s", qPrintable(path));
+        return;
+    }
+    qDebug("snapshot of %zu bytes written to %s", snapshot_buffer.size(), qPrintable(path));
+}
+
+
+/** Clears the input and the statistics of the previous session and starts stepping the one that was just reset.
+ */
+void Gameboard::begin_session() {
+
+    // forget keys that were held when the previous session ended
+    input.clear();
+
+    // statistics are reported per session
+    first_frame_ms = -1;
+    frame_clock.invalidate();
+    frame_times.clear();
+    paint_times.clear();
+    input_latency.clear();
+    dropped_frames = 0;
+
+    // the timer was stopped when the previous session ended
+    clock.start();
+    dirty.invalidate();
+    if (frame_timer_id == 0)
+        frame_timer_id = startTimer(qMax(1, qRound(frame_budget_ms)), Qt::PreciseTimer);
+    update();
+}
+
+
+/** Stops stepping a session that has ended. A played session is saved as space_invaders_last_session.sirp in the working directory, so it can be watched again with --replay; a replay reports whether it matched its recording. Sessions restored from a snapshot are not saved.
+ */
+void Gameboard::end_session() {
+    killTimer(frame_timer_id);
+    frame_timer_id = 0;
+    report_frame_stats();
+
+    if (replaying) {
+        qDebug("replay of %lld ticks %s the recorded session", replay.get_ticks(), replay_matches(state, replay) ? "matched" : "did NOT match");
+        return;
+    }
+    if (!recording_active)
+        return;
+    recording.finish(state);
+    const QString path = QDir::current().filePath("space_invaders_last_session.sirp");
+    if (recording.save(QDir::toNativeSeparators(path).toStdString()))
+        qDebug("session recorded to %s", qPrintable(path));
+    else
+        qWarning("could not record the session to %s", qPrintable(path));
 }
 
+
+/** Chooses between drawing the board with QPainter and with the software blitter. Frame statistics start over, so they only describe one renderer.
+ * @param enabled is true to draw with the software blitter
+ */
+void Gameboard::set_software_blit(bool enabled) {
+    software_blit = enabled;
+    frame_clock.invalidate();
+    frame_times.clear();
+    paint_times.clear();
+    dropped_frames = 0;
+    dirty.invalidate();
+    update();
+}
+
+
 /** Destructor for Gameboard class
  */
 Gameboard::~Gameboard()
@@ -210,85 +212,158 @@ Gameboard::~Gameboard()
 
 
 
+/** Redraws the HUD if what it shows has changed since it was last drawn: the lives left, whether the boss battle has started, and the health of the boss. The HUD holds the "Lives Remaining" label with a ship for each life left and, during the boss battle, the "Boss Health" label and health bar.
+ */
+void Gameboard::update_hud() {
+    const int lives_count = state.get_lives_count();
+    const bool boss_battle = state.is_boss_battle();
+    const int boss_health = boss_battle && state.is_boss_alive() ? state.get_boss_health() : -1;
+    if (!hud.isNull() && hud.devicePixelRatio() == atlas_dpr && hud_lives == lives_count && hud_boss_battle == boss_battle && hud_boss_health == boss_health)
+        return;
+
+    hud_lives = lives_count;
+    hud_boss_battle = boss_battle;
+    hud_boss_health = boss_health;
+
+    // the image is only created again if the board moved to a screen with another pixel ratio. It is premultiplied, so the software blitter can blend it as it is.
+    if (hud.isNull() || hud.devicePixelRatio() != atlas_dpr) {
+        hud = QImage(QSize(hud_box.width, hud_box.height) * atlas_dpr, QImage::Format_ARGB32_Premultiplied);
+        hud.setDevicePixelRatio(atlas_dpr);
+    }
+    hud.fill(Qt::transparent);
+
+    QPainter p(&hud);
+    p.translate(-hud_box.dx, -hud_box.dy);
+    p.setPen(Qt::black);
+
+    // draw the "Lives Remaining" label, and images of spaceships next to it to indicate how many lives are left
+    sprites.add(sprite_lives_remaining, lives_label_box.dx, lives_label_box.dy);
+    for (int lives_drawn = 0; lives_drawn < lives_count-1; ++lives_drawn)
+        sprites.add(sprite_lives_icon, lives_icon_box.dx + lives_icon_spacing*lives_drawn, lives_icon_box.dy);
+
+    // draw "Boss Health" message that will be displayed below the boss health bar
+    if (boss_battle)
+        sprites.add(sprite_boss_health, boss_health_label_box.dx, boss_health_label_box.dy);
+    sprites.draw(p);
+
+    // draw the health bar while the boss is alive
+    if (boss_health >= 0) {
+        p.setBrush(Qt::red);
+        p.drawRect(health_bar_box.dx, health_bar_box.dy, health_bar_width(state), health_bar_box.height);
+    }
+}
+
+
+/** Draws the HUD and the sprites in the batch with the software blitter, and presents them with one copy. Only the area being repainted is drawn.
+ * @param p is the painter of the board
+ * @param area is the area being repainted, in logical pixels
+ */
+void Gameboard::blit_frame(QPainter& p, const QRect& area) {
+    // the backbuffer covers the board in device pixels, and is only created again when the board is resized or moves to a screen with another pixel ratio
+    const QSize device_size = size() * atlas_dpr;
+    if (backbuffer.size() != device_size)
+        backbuffer = QImage(device_size, QImage::Format_ARGB32_Premultiplied);
+
+    // the area in device pixels, rounded outwards so that it covers every pixel the logical area touches
+    const QRect device_area = QRect(QPoint(qFloor(area.left() * atlas_dpr), qFloor(area.top() * atlas_dpr)),
+                                    QPoint(qCeil((area.right() + 1) * atlas_dpr) - 1, qCeil((area.bottom() + 1) * atlas_dpr) - 1)) & backbuffer.rect();
+    const ImageView target = sub_image(image_view(backbuffer), device_area.x(), device_area.y(), device_area.width(), device_area.height());
+
+    // clear the area to the background of the board, then blend the HUD and the sprites over it in the same order as QPainter draws them. Sprites outside the area are clipped away.
+    const QImage& hud_image = hud;
+    fill_image(target, qPremultiply(palette().color(backgroundRole()).rgba()));
+    blend_image(target, qRound(hud_box.dx * atlas_dpr) - device_area.x(), qRound(hud_box.dy * atlas_dpr) - device_area.y(), image_view(hud_image));
+    sprites.blit(target, device_area.x(), device_area.y(), atlas_dpr);
+    if (device_area.isEmpty())
+        return;
+
+    p.drawImage(QRectF(device_area.x() / atlas_dpr, device_area.y() / atlas_dpr, device_area.width() / atlas_dpr, device_area.height() / atlas_dpr),
+                backbuffer, QRectF(device_area));
+}
+
+
 /** This function is responsible for displaying everything on the game screen, including the player, enemies, and all text and messages.
+ *
+ * The HUD is drawn first as a single cached image. All other sprites are then added to a batch and drawn from the sprite atlas with one call,
+ * or blended into a backbuffer by the software blitter.
  */
-void Gameboard::paintEvent(QPaintEvent *) {
+void Gameboard::paintEvent(QPaintEvent *e) {
+    ProfileScope scope("paintEvent");
+
+    // measure the time since the previous frame was painted. A frame that took more than one and a half display frames means at least one frame was dropped.
+    if (frame_clock.isValid()) {
+        const double frame_ms = frame_clock.nsecsElapsed() / 1e6;
+        frame_times.add(frame_ms);
+        if (frame_ms > 1.5 * frame_budget_ms)
+            dropped_frames += qRound(frame_ms / frame_budget_ms) - 1;
+    }
+    frame_clock.start();
+    if (first_frame_ms < 0)
+        first_frame_ms = setup_clock.nsecsElapsed() / 1e6;
+
+    // the sprites are scaled for the screen the board is on, so another atlas is needed if it moved to a screen with another pixel ratio. Atlases are shared by every session.
+    if (devicePixelRatioF() != atlas_dpr) {
+        atlas_dpr = devicePixelRatioF();
+        sprites.set_atlas(&AssetRegistry::instance().game_atlas(atlas_dpr));
+    }
+
     QPainter p(this);
     p.setPen(Qt::black);
     p.setBrush(Qt::black);
 
+    const std::pair<int,int> player_position = state.get_player_position();
+    const Formation& enemies = state.get_enemies();
+    const BulletArray& player_bullets = state.get_player_bullets();
+    const BulletArray& enemy_bullets = state.get_enemy_bullets();
+    const BulletArray& boss_bullets = state.get_boss_bullets();
+
+    // draw the labels, lives and boss health bar at the top of the screen with one copy
+    update_hud();
+    if (!software_blit)
+        p.drawImage(hud_box.dx, hud_box.dy, hud);
+
     // If boss battle is taking place
     //
     //
-    if (start_boss_battle) {
-
-        // draw the "Lives Remaining" label at the top of the screen
-        p.drawPixmap(0,10,182,26,lives_remaining_message);
-        int lives_drawn = 0;
-
-        // draw images of spaceships next to "Lives Remaining" to indicate how many lives are left
-        while (lives_drawn < lives_count-1) {
-            p.drawPixmap(175+30*lives_drawn,10,25,25,spaceship);
-            ++lives_drawn;
-        }
-
-        // draw "Boss Health" message that will be displayed below the boss health bar
-        p.drawPixmap(0,50,138,26,boss_health_message);
+    if (state.is_boss_battle()) {
 
         // draw the player bullets
-        for (auto& x : player_bullet_positions)
-            p.drawPixmap(x.first, x.second, 11, 15, player_bullet);
+        for (size_t i = 0, n = player_bullets.size(); i < n; ++i)
+            sprites.add(sprite_player_bullet, player_bullets.x[i], player_bullets.y[i]);
 
         // draw the boss bullets. Because the boss fires three bullets at a time in different directions, three separate bullet images were created to match whichever direction the bullet is being fired. The bullets must be matched to their proper image.
-        for (auto& x : boss_bullet_positions) {
-            if (std::get<2>(x) == 1)
-                p.drawPixmap(std::get<0>(x), std::get<1>(x), 20, 20, enemy_bullet_left);
-            if (std::get<2>(x) == 2)
-                p.drawPixmap(std::get<0>(x), std::get<1>(x), 11, 15, enemy_bullet);
-            if (std::get<2>(x) == 3)
-                p.drawPixmap(std::get<0>(x), std::get<1>(x), 20, 20, enemy_bullet_right);
+        for (size_t i = 0, n = boss_bullets.size(); i < n; ++i) {
+            if (boss_bullets.kind[i] == boss_shot_left)
+                sprites.add(sprite_enemy_bullet_left, boss_bullets.x[i], boss_bullets.y[i]);
+            if (boss_bullets.kind[i] == boss_shot_down)
+                sprites.add(sprite_enemy_bullet, boss_bullets.x[i], boss_bullets.y[i]);
+            if (boss_bullets.kind[i] == boss_shot_right)
+                sprites.add(sprite_enemy_bullet_right, boss_bullets.x[i], boss_bullets.y[i]);
         }
 
         // if player is alive, draw the player
-        if (alive)
-            p.drawPixmap(player_position.first-10, player_position.second, 30, 30, spaceship);
+        if (state.is_alive())
+            sprites.add(sprite_spaceship, player_position.first + player_box.dx, player_position.second + player_box.dy);
 
         // if explosions are taking place on screen, draw the explosions. The std::vector explosion_locations stores both the x and y coordinates of the explosions and an integer indicating which frame of the explosion is being displayed.
-        if (explosion_locations.size() > 0) {
-            for (const auto& x : explosion_locations)
-                p.drawPixmap(x.first.first-10, x.first.second, 30, 30, explosions[x.second]);
-        }
+        for (const auto& x : state.get_explosion_locations())
+            sprites.add(sprite_explosion + x.second, x.first.first + explosion_box.dx, x.first.second + explosion_box.dy);
 
-        // if the boss is alive, draw the boss and the health bar.
-        if (boss_alive) {
-            p.setBrush(Qt::red);
-            p.drawRect(10,40,680-(680/total_boss_health)*(total_boss_health-boss_health),10);
-            p.drawPixmap(boss_position.first-50,boss_position.second,100,53,boss);
+        // if the boss is alive, draw the boss. Its health bar is part of the HUD.
+        if (state.is_boss_alive()) {
+            const std::pair<int,int> boss_position = state.get_boss_position();
+            sprites.add(sprite_boss, boss_position.first + boss_box.dx, boss_position.second + boss_box.dy);
         }
 
-        // if boss is dead, start two timers that will display the win message and an explosion animation
-        if (boss_health == 0) {
-            if (!win_message_timer->isActive())
-                win_message_timer->start();
-            if (!boss_explosion_timer->isActive())
-                boss_explosion_timer->start();
-
-            boss_alive = false;
-
-            // draw the explosion
-            p.drawPixmap(boss_explosion_location.first.first-40, boss_explosion_location.first.second, 80, 80, explosions[boss_explosion_location.second]);
-
+        // if boss is dead, draw the explosion
+        if (state.get_boss_health() == 0) {
+            const std::pair<std::pair<int,int>, int>& boss_explosion_location = state.get_boss_explosion_location();
+            sprites.add(sprite_boss_explosion + boss_explosion_location.second, boss_explosion_location.first.first + boss_explosion_box.dx, boss_explosion_location.first.second + boss_explosion_box.dy);
         }
 
         // display win message
-        if (win_message)
-            p.drawPixmap(170,100,385,54,win_text);
-
-        // if player has 0 lives, then start a timer that will display the game over screen
-        if (lives_count < 1) {
-            if (!game_over_timer->isActive())
-                game_over_timer->start();
-        }
+        if (state.is_win_message())
+            sprites.add(sprite_win_text, win_message_box.dx, win_message_box.dy);
     }
 
 
@@ -297,49 +372,27 @@ void Gameboard::paintEvent(QPaintEvent *) {
     // When all enemies have been defeated but the boss has not appeared yet.
     //
     //
-    else if (enemy_positions.empty()) {
-
-        // draw the "Lives Remaining" label at the top of the screen
-        p.drawPixmap(0,10,182,26,lives_remaining_message);
-        int lives_drawn = 0;
-
-        // draw images of spaceships next to "Lives Remaining" to indicate how many lives are left
-        while (lives_drawn < lives_count-1) {
-            p.drawPixmap(175+30*lives_drawn,10,25,25,spaceship);
-            ++lives_drawn;
-        }
+    else if (enemies.empty()) {
 
         // draw player bullets
-        for (auto& x : player_bullet_positions)
-            p.drawPixmap(x.first, x.second, 11, 15, player_bullet);
+        for (size_t i = 0, n = player_bullets.size(); i < n; ++i)
+            sprites.add(sprite_player_bullet, player_bullets.x[i], player_bullets.y[i]);
 
         // draw enemy bullets
-        for (auto& x : enemy_bullet_positions)
-            p.drawPixmap(x.first, x.second, 11, 15, enemy_bullet);
+        for (size_t i = 0, n = enemy_bullets.size(); i < n; ++i)
+            sprites.add(sprite_enemy_bullet, enemy_bullets.x[i], enemy_bullets.y[i]);
 
         // if player is alive, draw player. It is possible for player to be hit by a bullet after all enemies have been defeated.
-        if (alive)
-            p.drawPixmap(player_position.first-10, player_position.second, 30, 30, spaceship);
-
-        // start timer that will display the "boss battle" message and start the boss battle
-        if (!boss_battle_timer->isActive())
-            boss_battle_timer->start();
+        if (state.is_alive())
+            sprites.add(sprite_spaceship, player_position.first + player_box.dx, player_position.second + player_box.dy);
 
         // if explosions are occuring, draw explosions
-        if (explosion_locations.size() > 0) {
-            for (const auto& x : explosion_locations)
-                p.drawPixmap(x.first.first-10, x.first.second, 30, 30, explosions[x.second]);
-        }
-
-        // display win message
-        if (boss_message)
-            p.drawPixmap(90,100,534,54,boss_text);
+        for (const auto& x : state.get_explosion_locations())
+            sprites.add(sprite_explosion + x.second, x.first.first + explosion_box.dx, x.first.second + explosion_box.dy);
 
-        // if player has 0 lives, then start timer that will display game over screen. Again, it is still possible for a player to be hit by a bullet after all enemies have been defeated.
-        if (lives_count < 1) {
-            if (!game_over_timer->isActive())
-                game_over_timer->start();
-        }
+        // display boss battle message
+        if (state.is_boss_message())
+            sprites.add(sprite_boss_text, boss_message_box.dx, boss_message_box.dy);
     }
 
 
@@ -350,502 +403,231 @@ void Gameboard::paintEvent(QPaintEvent *) {
     //
     else {
 
-        // draw the "Lives Remaining" label at the top of the screen
-        p.drawPixmap(0,10,182,26,lives_remaining_message);
-        int lives_drawn = 0;
-
-        // draw images of spaceships next to "Lives Remaining" to indicate how many lives are left
-        while (lives_drawn < lives_count-1) {
-            p.drawPixmap(175+30*lives_drawn,10,25,25,spaceship);
-            ++lives_drawn;
-        }
-
         // draw enemies
-        for (const auto& x : enemy_positions)
-            p.drawPixmap(x.first-12, x.second, 35, 23, invader);
+        enemies.for_each([&](int x, int y) { sprites.add(sprite_invader, x + invader_box.dx, y + invader_box.dy); });
 
         // if explosions are occurring, draw explosions
-        if (explosion_locations.size() > 0) {
-            for (const auto& x : explosion_locations)
-                p.drawPixmap(x.first.first-10, x.first.second, 30, 30, explosions[x.second]);
-        }
+        for (const auto& x : state.get_explosion_locations())
+            sprites.add(sprite_explosion + x.second, x.first.first + explosion_box.dx, x.first.second + explosion_box.dy);
 
         // player is alive, draw player
-        if (alive)
-            p.drawPixmap(player_position.first-10, player_position.second, 30, 30, spaceship);
+        if (state.is_alive())
+            sprites.add(sprite_spaceship, player_position.first + player_box.dx, player_position.second + player_box.dy);
 
         // draw player bullets
-        for (auto& x : player_bullet_positions)
-            p.drawPixmap(x.first, x.second, 11, 15, player_bullet);
+        for (size_t i = 0, n = player_bullets.size(); i < n; ++i)
+            sprites.add(sprite_player_bullet, player_bullets.x[i], player_bullets.y[i]);
 
         // draw enemy bullets
-        for (auto& x : enemy_bullet_positions)
-            p.drawPixmap(x.first, x.second, 11, 15, enemy_bullet);
-
-        // if player has 0 lives or enemies reach the botton of the screen, start a timer that will display game over screen
-        if (lives_count < 1 || enemy_positions[enemy_positions.size()-1].second > 400) {
-            if (!game_over_timer->isActive())
-                game_over_timer->start();
-        }
-    }
-}
-
-/** Records the state of key presses in the QMap keys. Normally, when a key is held down there is a delay before the key is repeated. Storing the state of the key presses and rapidly checking the states will bypass this. This function also fires a bullet from the player's position when space is pressed.
- * @param e is the key press event
- */
-void Gameboard::keyPressEvent(QKeyEvent *e) {
-
-    keys[e->key()] = true;
-    if (keys[Qt::Key_Space]) {
-
-        // if shoot timer is active, then player won't be able to fire. This sets the fastest fire rate of the player.
-        if (!shoot_timer->isActive()) {
-            player_bullet_positions.push_back(player_position);
-            shoot_timer->start();
-        }
+        for (size_t i = 0, n = enemy_bullets.size(); i < n; ++i)
+            sprites.add(sprite_enemy_bullet, enemy_bullets.x[i], enemy_bullets.y[i]);
     }
 
-    QWidget::keyPressEvent(e);
+    // draw every sprite in front of the HUD
+    if (software_blit)
+        blit_frame(p, e->rect());
+    else
+        sprites.draw(p);
 
-}
+    if (profile_overlay)
+        draw_profile_overlay(p);
 
+    paint_times.add(frame_clock.nsecsElapsed() / 1e6);
 
-/** Records when a key is released.
- * @param e is the key release event
- */
-void Gameboard::keyReleaseEvent(QKeyEvent *e) {
-    keys[e->key()] = false;
-    QWidget::keyReleaseEvent(e);
+    // the key presses consumed since the previous frame are visible now. Presenting on screen adds the compositor's delay, which is not measured.
+    input.presented(input_clock.nsecsElapsed(), input_latency);
 }
 
 
-/** Enables smooth player movement. Every time the timer times out, the state of the keys (whether they are pressed or not) is checked. If the left or right keys are pressed down, then the player will be moved accordingly. This will bypass the slight delay that normally occurs when a key is held down.
+/** Returns the key of the game that a keyboard key controls, or -1 if it does not control the game.
+ * @param key is the Qt::Key
  */
-void Gameboard::timerEvent(QTimerEvent *) {
-    if (keys[Qt::Key_Left]) {
-        if (player_position.first > 10)
-            player_position.first -= 5;
+static int game_key(int key) {
+    switch (key) {
+    case Qt::Key_Left: return key_left;
+    case Qt::Key_Right: return key_right;
+    case Qt::Key_Space: return key_fire;
+    default: return -1;
     }
-
-    if (keys[Qt::Key_Right]) {
-        if (player_position.first < 680)
-            player_position.first += 5;
-    }
-
-    QCoreApplication::processEvents();
-    repaint();
-
 }
 
-
-/** Sets the focus of the gameboard when it first appears
- * @param e is the show event
- */
-void Gameboard::showEvent(QShowEvent *e) {
-    this->activateWindow();
-    this->setFocus();
-    QWidget::showEvent(e);
-}
-
-
-/** Move the boss from side to side.
+/** Queues presses of the game keys with the time they arrived. The simulation applies them at the start of its next tick, so moving and firing react after the same delay. Held keys stay held until they are released, so the delay before a key repeats does not matter and repeats are ignored.
+ * F2 switches between drawing with QPainter and with the software blitter. The statistics of the renderer that was used until then are printed, so the two can be compared.
+ * F3 shows or hides the profile overlay. F4 starts recording a trace, and pressing it again exports the recorded profile as a Chrome trace.
+ * F5 saves a snapshot of the session and F9 goes back to it.
+ * @param e is the key press event
  */
-void Gameboard::move_boss() {
-
-    // if boss is moving right and has not reached the far right of the screen, move it right
-    if (boss_position.first + 20 < 700 && boss_moving_right) {
-        boss_position.first += 3;
-    }
+void Gameboard::keyPressEvent(QKeyEvent *e) {
 
-    // if boss is at far right, then switch directions
-    else if (boss_position.first + 20 >= 700 && boss_moving_right) {
-        boss_moving_right = false;
+    if (e->key() == Qt::Key_F3 && !e->isAutoRepeat()) {
+        profile_overlay = !profile_overlay;
+        update_profiling();
+        dirty.invalidate();
+        update();
+        return;
     }
-
-    // if boss is moving left is has not reached the far left of the screen, move it left
-    else if (boss_position.first > 0 && !boss_moving_right) {
-        boss_position.first -= 3;
+    if (e->key() == Qt::Key_F4 && !e->isAutoRepeat()) {
+        if (trace_recording)
+            export_trace();
+        else
+            qDebug("recording a trace, press F4 again to write it");
+        trace_recording = !trace_recording;
+        update_profiling();
+        return;
     }
-
-    // if boss is at far left, then switch directions
-    else if (boss_position.first <= 0 && !boss_moving_right) {
-        boss_moving_right = true;
+    if (e->key() == Qt::Key_F5 && !e->isAutoRepeat()) {
+        save_snapshot();
+        return;
     }
-}
-
-
-
-/** Move the enemies side to side.
- */
-void Gameboard::move_enemies() {
-
-    // if enemies are present
-    if (enemy_positions.size() > 0) {
-
-        // if enemies are moving right and rightmost enemy has not reached the far right of the screen, move enemies right
-        if (enemy_positions[enemy_positions.size()-1].first + 20 < 700 && moving_right) {
-            for (auto& x : enemy_positions)
-                x.first += 20;
-        }
-
-        // if rightmost enemy is at far right of screen, then move enemies down and change directions
-        else if (enemy_positions[enemy_positions.size()-1].first + 20 >= 700 && moving_right) {
-            for (auto& x : enemy_positions)
-                x.second += 20;
-            moving_right = false;
-        }
-
-        // if enemies are moving left and leftmost enemy has not reached the far left of the screen, move enemies left
-        else if (enemy_positions[0].first - 20 > 0 && !moving_right) {
-            for (auto& x : enemy_positions)
-                x.first -= 20;
-        }
-
-        // if leftmost enemy is at far left of screen, then move enemies down and change directions
-        else if (enemy_positions[0].first - 20 <= 0 && !moving_right) {
-            for (auto& x : enemy_positions)
-                x.second += 20;
-            moving_right = true;
-        }
-    }
-}
-
-
-/** Move player's and enemies' bullets. Also remove bullets they go offscreen.
- */
-void Gameboard::move_bullets() {
-    bool player_removed = false;
-    bool enemy_removed = false;
-    int player_to_be_removed;
-    int enemy_to_be_removed;
-
-    // move each of the player's bullets up
-    for (size_t i = 0, n = player_bullet_positions.size(); i < n; ++i) {
-        player_bullet_positions[i].second -= 3;
-
-        // if player's bullets reach the top of the screen, then remove them
-        if (player_bullet_positions[i].second < 0) {
-            player_removed = true;
-            player_to_be_removed = i;
-        }
+    if (e->key() == Qt::Key_F9 && !e->isAutoRepeat()) {
+        restore_snapshot(QDir::current().filePath("space_invaders_quicksave.siss"));
+        return;
     }
 
-    // move each of the enemies' bullets down
-    for (size_t i = 0, n = enemy_bullet_positions.size(); i < n; ++i) {
-        enemy_bullet_positions[i].second += 3;
-
-        // if enemies' bullets reach bottom of the screen, then remove them
-        if (enemy_bullet_positions[i].second > 550) {
-            enemy_removed = true;
-            enemy_to_be_removed = i;
-        }
-
+    if (e->key() == Qt::Key_F2 && !e->isAutoRepeat()) {
+        report_frame_stats();
+        set_software_blit(!software_blit);
+        qDebug("renderer: %s", software_blit ? simd_path_name(active_blit_path()) : "qpainter");
+        return;
     }
 
-    // if player's bullets to be removed, then erase them from the vector containing all the player's bullet positions
-    if (player_removed) {
-       player_bullet_positions.erase(player_bullet_positions.begin() + player_to_be_removed);
-    }
+    const int key = game_key(e->key());
+    if (key >= 0 && !e->isAutoRepeat())
+        input.push(key, true, input_clock.nsecsElapsed());
 
-    // if enemies' bullets to be removed, then erase them from the vector containing all the enemies' bullet positions
-    if (enemy_removed) {
-       enemy_bullet_positions.erase(enemy_bullet_positions.begin() + enemy_to_be_removed);
-    }
-}
-
-/** Randomly fires bullets from enemies. Enemy bullets are stored in a vector of std::pairs that contain the x and y coordinates of the bullets.
- */
-void Gameboard::enemy_fire_bullet() {
+    QWidget::keyPressEvent(e);
 
-    // if enemies present, then select an enemy at random and store its location in the vector containing the enemies' bullet positions
-    if (enemy_positions.size() > 0) {
-        std::uniform_int_distribution<int> distribution(0,enemy_positions.size()-1);
-        enemy_bullet_positions.push_back(enemy_positions[distribution(generator)]);
-    }
 }
 
 
-/** Fires bullets from boss. Boss bullets are stored in a vector of std::tuples containing three elements. The first two elements in the tuple are the x and y coordinates of the bullet. The third element is an integer than indicates which direction the boss's bullets should go. 1 corresponds to moving at a 45 degree angle to the left, 2 corresponds to moving straight down, and 3 corrresponds to moving at a 45 degree angle to the right.
+/** Queues releases of the game keys with the time they arrived.
+ * @param e is the key release event
  */
-void Gameboard::boss_fire_bullet() {
-
-    // boss fires one of each type of bullet at a time
-    if (boss_alive) {
-        boss_bullet_positions.push_back(std::make_tuple(boss_position.first, boss_position.second, 1));
-        boss_bullet_positions.push_back(std::make_tuple(boss_position.first, boss_position.second, 2));
-        boss_bullet_positions.push_back(std::make_tuple(boss_position.first, boss_position.second, 3));
-    }
+void Gameboard::keyReleaseEvent(QKeyEvent *e) {
+    const int key = game_key(e->key());
+    if (key >= 0 && !e->isAutoRepeat())
+        input.push(key, false, input_clock.nsecsElapsed());
+    QWidget::keyReleaseEvent(e);
 }
 
 
-/** Move boss bullets down or diagonally depending on the type of bullet. Also removes bullets if they go offscreen.
+/** Steps the simulation by the real time that passed since the previous call and schedules a repaint of the areas that changed. The simulation consumes the queued key presses at the start of each tick. Emits the game over or win signal once the session has ended.
+ *
+ * The timer runs once per display frame and update() coalesces repaints, so the board is painted at most once per frame and the event loop is never re-entered.
  */
-void Gameboard::move_boss_bullet() {
-    bool boss_removed = false;
-    int boss_to_be_removed;
-
-    for (size_t i = 0, n = boss_bullet_positions.size(); i < n; ++i) {
-
-        // 1 corresponds to a bullet that is moving 45 degrees to the left
-        if (std::get<2>(boss_bullet_positions[i]) == 1) {
-            std::get<1>(boss_bullet_positions[i]) += 2;
-            std::get<0>(boss_bullet_positions[i]) -= 2;
-        }
-
-        // 2 corresponds to a bullet that is moving straight down
-        if (std::get<2>(boss_bullet_positions[i]) == 2) {
-            std::get<1>(boss_bullet_positions[i]) += 3;
-        }
-
-        // 3 corresponds to a bullet that is moving 45 degrees to the right
-        if (std::get<2>(boss_bullet_positions[i]) == 3) {
-            std::get<1>(boss_bullet_positions[i]) += 2;
-            std::get<0>(boss_bullet_positions[i]) += 2;
-        }
+void Gameboard::timerEvent(QTimerEvent *) {
 
-        // if bullets reach the bottom or sides of the screen, then remove them
-        if (std::get<1>(boss_bullet_positions[i]) > 550 || std::get<0>(boss_bullet_positions[i]) < 10 || std::get<0>(boss_bullet_positions[i]) > 700) {
-            boss_removed = true;
-            boss_to_be_removed = i;
-        }
+    // a long stall (e.g. the window being dragged) is not caught up on, so the game does not jump ahead
+    const int dt = std::min<qint64>(clock.restart(), 250);
+    if (replaying) {
+        // never run past the end of the recording, which may have been cut short before the session ended
+        const long long remaining = replay.get_ticks() - state.get_ticks();
+        state.step(static_cast<int>(std::min<long long>(dt, remaining * GameState::tick_ms)), replay_player);
     }
+    else
+        state.step(dt, input);
 
-    // if bullets to be removed, then erase them from the vector of boss bullet locations
-    if (boss_removed) {
-        boss_bullet_positions.erase(boss_bullet_positions.begin() + boss_to_be_removed);
+    // repaint only the areas that changed since the previous frame. Past a number of areas, one full repaint is cheaper than clipping to all of them. The profile overlay changes every frame, so it repaints everything.
+    if (dirty.update(state) || dirty.get_changed().size() > max_dirty_rects || profile_overlay) {
+        update();
     }
-}
-
-
-/** This function detects collisions between player bullets and enemies. Removes enemies and bullets if player bullets hit them.
- */
-void Gameboard::remove_enemy() {
-    bool removed = false;
-    int to_be_removed_enemy;
-    int to_be_removed_bullet;
-    std::pair<int,int> position;
-
-    // checks each bullets with each enemy to determine if their positions overlap. If they do, then stores their positions in their respective vectors for removal.
-    if (enemy_positions.size() > 0) {
-        for (size_t i = 0, n = player_bullet_positions.size(); i < n; ++i) {
-            for (size_t j = 0, m = enemy_positions.size(); j < m; ++j) {
-                if ((player_bullet_positions[i].first > enemy_positions[j].first-20 && player_bullet_positions[i].first < enemy_positions[j].first+20) && (player_bullet_positions[i].second > enemy_positions[j].second-11 && player_bullet_positions[i].second < enemy_positions[j].second+11)) {
-                    removed = true;
-                    position = enemy_positions[j];
-                    to_be_removed_enemy = j;
-                    to_be_removed_bullet = i;
-                }
-            }
-        }
+    else if (!dirty.get_changed().empty()) {
+        QRegion region;
+        for (const DrawBox& box : dirty.get_changed())
+            region += QRect(box.left, box.top, box.width, box.height);
+        update(region);
     }
-
-    // removes enemy and bullet from their corresponding position vectors
-    if (removed) {
-        player_bullet_positions.erase(player_bullet_positions.begin() + to_be_removed_bullet);
-        enemy_positions.erase(enemy_positions.begin() + to_be_removed_enemy);
-
-        // adds position of enemy death to explosion location vector
-        explosion_locations.push_back(std::make_pair(position, 0));
+    else {
+        // nothing to paint this frame, so the gap before the next painted frame is not a dropped frame
+        frame_clock.invalidate();
     }
-}
 
-
-/** Checks for collisions between enemy bullets and player. If collisions occur, then remove bullets and decrement lives count.
- */
-void Gameboard::player_hit() {
-    bool removed = false;
-    int to_be_removed_bullet;
-    std::pair<int,int> position;
-
-    // compares each enemy bullet with player to see if their positions overlap. If they do, then stores the positions of the player and the bullet for removal
-    for (size_t i = 0, n = enemy_bullet_positions.size(); i < n; ++i) {
-        if ((enemy_bullet_positions[i].first > player_position.first-15 && enemy_bullet_positions[i].first < player_position.first+15) && (enemy_bullet_positions[i].second > player_position.second-10 && enemy_bullet_positions[i].second < player_position.second+10)) {
-            removed = true;
-            to_be_removed_bullet = i;
-            position = player_position;
-        }
+    // once the session has ended, stop stepping and tell the main window which screen to display. A replay of a session that was cut short ends with its recording.
+    if (state.get_outcome() != GameOutcome::Playing) {
+        end_session();
+        if (state.get_outcome() == GameOutcome::Lost)
+            emit game_over();
+        else
+            emit win_game();
     }
-
-    // if collision occurs
-    if (removed) {
-
-        // remove enemy bullet from vector of enemy bullet locations
-        enemy_bullet_positions.erase(enemy_bullet_positions.begin() + to_be_removed_bullet);
-
-        // decrement lives count
-        --lives_count;
-        alive = false;
-
-        // temporarily move player off screen while player respawns
-        player_position = std::make_pair(-50,-50);
-
-        // add explosion to explosion locations vector
-        explosion_locations.push_back(std::make_pair(position, 0));
-
-        // start respawn timer
-        respawn_timer->start();
+    else if (replaying && replay_player.is_finished()) {
+        end_session();
+        emit game_over();
     }
 }
 
 
-/** Checks for collisions between boss bullets and player. If collisions occur, then remove boss bullets and decrement lives count.
+/** Prints the frame pacing statistics of the session: time from creating the board to its first frame, mean and 99th percentile time between frames, dropped frames, and time spent painting with the current renderer. Also prints the time spent loading assets so far.
+ * Counts and means cover the whole session. Percentiles and maxima cover the samples that are kept, which are the most recent ones in a long session.
  */
-void Gameboard::player_hit_boss() {
-    bool removed = false;
-    int to_be_removed_bullet;
-    std::pair<int,int> position;
-
-    // compares each boss bullet with player to see if their positions overlap. If they do, then stores the positions of the player and the bullet for removal
-    for (size_t i = 0, n = boss_bullet_positions.size(); i < n; ++i) {
-        if ((std::get<0>(boss_bullet_positions[i]) > player_position.first-15 && std::get<0>(boss_bullet_positions[i]) < player_position.first+15) && (std::get<1>(boss_bullet_positions[i]) > player_position.second-10 && std::get<1>(boss_bullet_positions[i]) < player_position.second+10)) {
-            removed = true;
-            to_be_removed_bullet = i;
-            position = player_position;
-        }
-    }
-
-    // if collision occurs
-    if (removed) {
-
-        // remove boss bullet from vector of boss bullet locations
-        boss_bullet_positions.erase(boss_bullet_positions.begin() + to_be_removed_bullet);
-
-        // decrement lives count
-        --lives_count;
-        alive = false;
-
-        // temporarily move player off screen while player respawns
-        player_position = std::make_pair(-50,-50);
-
-        // add explosion to explosion locations vector
-        explosion_locations.push_back(std::make_pair(position,0));
-
-        // start respawn timer
-        respawn_timer->start();
-    }
+void Gameboard::report_frame_stats() const {
+    qDebug("first frame %.2f ms after the board was created", first_frame_ms);
+    qDebug("renderer %s, frames: %lld, budget %.2f ms, mean %.2f ms, dropped %lld, paint mean %.3f ms; last %zu frames: p99 %.2f ms, paint p99 %.3f ms",
+           software_blit ? simd_path_name(active_blit_path()) : "qpainter", frame_times.total_count(), frame_budget_ms, frame_times.total_mean(), dropped_frames,
+           paint_times.total_mean(), frame_times.count(), frame_times.percentile(99), paint_times.percentile(99));
+    qDebug("input to frame latency: %lld key changes, mean %.2f ms; last %zu changes: p50 %.2f ms, p99 %.2f ms, max %.2f ms",
+           input_latency.total_count(), input_latency.total_mean(), input_latency.count(), input_latency.percentile(50), input_latency.percentile(99), input_latency.max());
+    AssetRegistry::instance().report();
 }
 
 
-/** Checks for collisions between player bullets and boss. If collisions occur, then remove player bullets and decrement boss health.
- */
-void Gameboard::boss_hit() {
-    bool removed = false;
-    int to_be_removed_bullet;
-
-    // compares each player bullet with boss to see if their positions overlap. If they do, then stores the positions of the bullet for removal
-    if (boss_alive) {
-        for (size_t i = 0, n = player_bullet_positions.size(); i < n; ++i) {
-            if ((player_bullet_positions[i].first > boss_position.first-50 && player_bullet_positions[i].first < boss_position.first+50) && (player_bullet_positions[i].second > boss_position.second-30 && player_bullet_positions[i].second < boss_position.second+30)) {
-                removed = true;
-                to_be_removed_bullet = i;
-            }
-        }
-
-        // if collision occurs, then remove bullet from vector of player bullet locations and decrement boss health
-        if (removed) {
-            player_bullet_positions.erase(player_bullet_positions.begin() + to_be_removed_bullet);
-            --boss_health;
-        }
-
-        // if boss has no health left, then set boss explosion location to boss's current location
-        if (boss_health == 0)
-            boss_explosion_location = std::make_pair(boss_position,0);
-    }
-}
-
-/** Draws explosions for players and enemies. Explosion locations are stored in a vector of std::pairs, where the first element is itself an std::pair that stores the x and y coordinates of the explosion, and the second element is an integer between 0 and 13 that indicates which frame of the explosion is being displayed. This function increments the second element for each object, which advances the explosion animation to the next frame. It also removes the explosion once all 14 frames have been displayed.
+/** Draws the time spent in each profiled phase during the last second, in the bottom left corner of the board. Phases are listed from the one that took the most time.
+ * @param p is the painter of the board
  */
-void Gameboard::draw_explosion() {
-    bool removed = false;
-    int removed_pos;
-    for (int i = 0, n = explosion_locations.size(); i < n; ++i) {
-
-        // increment integer representing explosion frame
-        if (explosion_locations[i].second < 13)
-            ++explosion_locations[i].second;
-        else {
-            removed = true;
-            removed_pos = i;
-        }
-    }
-
-    // remove explosion once animation is finished
-    if (removed) {
-        explosion_locations.erase(explosion_locations.begin() + removed_pos);
+void Gameboard::draw_profile_overlay(QPainter& p) {
+    const Profiler& profiler = Profiler::instance();
+    const std::uint64_t now = profiler.now_ns();
+    profiler.summarize(now > 1000000000 ? now - 1000000000 : 0, profile_summaries);
+
+    const int line_height = 14;
+    const int top = height() - line_height * (static_cast<int>(profile_summaries.size()) + 1) - 4;
+    p.fillRect(0, top, 330, height() - top, QColor(0, 0, 0, 160));
+    QFont font("Monospace", 8);
+    font.setStyleHint(QFont::TypeWriter);
+    p.setFont(font);
+    p.setPen(Qt::white);
+    p.drawText(6, top + line_height, QString("phase (last second)        calls   total ms   max ms"));
+    for (size_t i = 0; i < profile_summaries.size(); ++i) {
+        const ProfileSummary& summary = profile_summaries[i];
+        p.drawText(6, top + line_height * (static_cast<int>(i) + 2),
+                   QString("%1 %2 %3 %4").arg(summary.name, -24).arg(summary.count, 7).arg(summary.total_ms, 10, 'f', 3).arg(summary.max_ms, 8, 'f', 3));
     }
-
-    QCoreApplication::processEvents();
-    repaint();
-}
-
-
-/** Draws explosion for boss.
- */
-void Gameboard::draw_boss_explosion() {
-    if (boss_explosion_location.second < 13)
-
-        // increments explosion frame
-        ++boss_explosion_location.second;
-    else
-
-        // moves animation offscreen once it is finished
-        boss_explosion_location.first = std::make_pair(-50,-50);
 }
 
 
-/** Emits a game_over signal. Connected to the game over timer.
+/** Turns the profiler on while the overlay is shown or a trace is being recorded, and off otherwise, so that a game that is not profiled does not pay for recording.
  */
-void Gameboard::emit_game_over()
-{
-    emit game_over();
+void Gameboard::update_profiling() {
+    Profiler& profiler = Profiler::instance();
+    const bool wanted = profile_overlay || trace_recording;
+    if (wanted && !profiler.is_enabled())
+        profiler.clear();
+    profiler.set_enabled(wanted);
 }
 
 
-/** This function is called after the player has been hit. It causes the player to reappear on screen and stops the respawn timer.
+/** Writes the events recorded by the profiler to a Chrome trace file in the working directory. The file can be opened in about:tracing.
  */
-void Gameboard::respawn() {
-    player_position = std::make_pair(350,410);
-    alive = true;
-    respawn_timer->stop();
-}
-
-/** After the final enemy is defeated, a timer connected to this function will start. This function will be called 2 times total. Before the first time the function is called, no message will be displayed but the player and bullets will still be displayed. This creates a delay before the appearance of the message. Once the function is called for the first time, it will display the "boss battle" message. The message will remain on screen for the duration of the timer interval until the function is called for the second time, which removes the message and starts the boss battle.
- */
-void Gameboard::boss_battle_message() {
-
-    // if boss message is not displayed, then it will be displayed
-    if (boss_message == false)
-        boss_message = true;
-
-    // if boss message is already displayed, then it will be removed and the boss battle will start
-    else if (boss_message == true) {
-        boss_message = false;
-        start_boss_battle = true;
-        boss_alive = true;
-        boss_battle_timer->stop(); // stops the boss battle timer so function is only called twice
-        enemy_fire_bullet_timer->stop();
-        enemy_timer->stop();
-        boss_move_timer->start();
-        boss_fire_rate_timer->start();
+void Gameboard::export_trace() const {
+    std::ostringstream stream;
+    Profiler::instance().write_chrome_trace(stream);
+    const std::string trace = stream.str();
+
+    const QString path = QDir::current().filePath(QString("space_invaders_trace_%1.json").arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss")));
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(trace.data(), trace.size()) < 0) {
+        qWarning("could not write trace to %s", qPrintable(path));
+        return;
     }
-
+    qDebug("trace written to %s", qPrintable(path));
 }
 
-/** This function operates similarly to Gameboard::boss_battle_message(). It will be called 2 times total and displays the win message after a delay. After the win message is displayed, the win signal is emitted.
- */
-void Gameboard::win_message_appear() {
-
-    // if win message is not displayed, then it will be displayed
-    if (win_message == false)
-        win_message = true;
 
-    // if win message is already displayed, then the win signal is emitted
-    else if (win_message == true) {
-        win_message_timer->stop();
-        emit win_game();
-    }
+/** Sets the focus of the gameboard when it first appears
+ * @param e is the show event
+ */
+void Gameboard::showEvent(QShowEvent *e) {
+    this->activateWindow();
+    this->setFocus();
+    QWidget::showEvent(e);
 }
-
-
-
-
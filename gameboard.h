@@ -10,11 +10,19 @@
 #include <QWidget>
 #include <vector>
 #include <utility>
-#include <QMap>
 #include <QLabel>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <tuple>
 #include <QPixmap>
+#include <QImage>
+#include "gamestate.h"
+#include "timingstats.h"
+#include "spriteatlas.h"
+#include "screenlayout.h"
+#include "profiler.h"
+#include "inputqueue.h"
+#include "replay.h"
 
 
 /** @namespace Ui
@@ -29,15 +37,23 @@ class Gameboard;
 /** @class Gameboard
  * @brief The actual "game" part of the app
  *
- * This class contains everything needed to play Space Invaders.
+ * This class displays a GameState and feeds it the player's key presses. The rules of the game live in GameState.
  */
 class Gameboard : public QWidget
 {
     Q_OBJECT
 
 public:
-    explicit Gameboard(QWidget *parent, int new_enemy_speed, int new_enemy_fire_rate, int new_boss_speed, int new_boss_fire_rate, int new_boss_health);
+    explicit Gameboard(QWidget *parent, const GameParams& params);
     ~Gameboard();
+    void reset(const GameParams& params);
+    void start_replay(const Replay& new_replay);
+    bool restore_snapshot(const QString& path);
+    void set_software_blit(bool enabled);
+
+    // the session being displayed, for tools that drive the board without the event loop, e.g. the benchmarks
+    GameState& get_state() { return state; }
+
     void paintEvent(QPaintEvent*);
     void keyPressEvent(QKeyEvent *e);
     void keyReleaseEvent(QKeyEvent *e);
@@ -48,113 +64,75 @@ signals:
     void game_over();
     void win_game();
 
-public slots:
-    void move_enemies();
-    void move_bullets();
-    void remove_enemy();
-    void enemy_fire_bullet();
-    void player_hit();
-    void respawn();
-    void boss_battle_message();
-    void move_boss();
-    void move_boss_bullet();
-    void boss_fire_bullet();
-    void player_hit_boss();
-    void boss_hit();
-    void win_message_appear();
-    void draw_explosion();
-    void draw_boss_explosion();
-    void emit_game_over();
-
-
 private:
     Ui::Gameboard *ui;
 
-    // stores the state of key presses for smooth movement
-    QMap<int,bool> keys;
-
-    // all the images in the game
-    QPixmap invader;
-    QPixmap spaceship;
-    QPixmap enemy_bullet;
-    QPixmap enemy_bullet_left;
-    QPixmap enemy_bullet_right;
-    QPixmap player_bullet;
-    QPixmap boss_text;
-    QPixmap win_text;
-    QPixmap boss;
-    QPixmap lives_remaining_message;
-    QPixmap boss_health_message;
-    std::vector<QPixmap> explosions;
-
-    // vectors that store explosion locations
-    std::vector<std::pair<std::pair<int,int>, int>> explosion_locations;
-    std::pair<std::pair<int,int>, int> boss_explosion_location;
-
-    // timers related to explosions
-    QTimer* explosion_timer;
-    QTimer* boss_explosion_timer;
-
-    // timers related to displaying messages
-    QTimer* boss_battle_timer;
-    QTimer* game_over_timer;
-    QTimer* win_message_timer;
-
-
-    // ************** PLAYER VARIABLES ****************//
-
-    // timers related to player respawn/fire-rate
-    QTimer* shoot_timer;
-    QTimer* respawn_timer;
-
-    // vectors that store player location and bullet locations
-    std::vector<std::pair<int,int>> player_bullet_positions;
-    std::pair<int,int> player_position;
-
-    // other variables related to player
-    bool alive;
-    bool moving_right;
-    int lives_count;
-
-
-    // ************** ENEMY VARIABLES *****************//
-
-    // timers related to enemy movement/fire-rate
-    QTimer* enemy_timer;
-    QTimer* bullet_timer;
-    QTimer* enemy_fire_bullet_timer;
-
-    // vectors that store enemy locations and bullet locations
-    std::vector<std::pair<int,int>> enemy_bullet_positions;
-    std::vector<std::pair<int,int>> enemy_positions;
-
-    // other variables related to enemies
-    int enemy_speed;
-    int enemy_fire_rate;
-
-
-    // ************** BOSS VARIABLES ****************//
-
-    // timers related to boss movement/fire-rate
-    QTimer* boss_move_timer;
-    QTimer* boss_bullet_timer;
-    QTimer* boss_fire_rate_timer;
-
-    // vectors that store boss position and bullet positions
-    std::pair<int,int> boss_position;
-    std::vector<std::tuple<int,int,int>> boss_bullet_positions;
-
-    // other variables related to boss
-    bool boss_message;
-    bool start_boss_battle;
-    bool boss_moving_right;
-    int boss_health;
-    int total_boss_health;
-    int boss_speed;
-    int boss_fire_rate;
-    bool win_message;
-    bool boss_alive;
-
+    // the simulation that is displayed by this widget
+    GameState state;
+
+    void report_frame_stats() const;
+    void update_hud();
+    void blit_frame(QPainter& p, const QRect& area);
+    void draw_profile_overlay(QPainter& p);
+    void export_trace() const;
+    void update_profiling();
+    void begin_session();
+    void end_session();
+    void save_snapshot();
+
+    // measures real time between two steps of the simulation
+    QElapsedTimer clock;
+
+    // steps the simulation and schedules a repaint once per display frame
+    int frame_timer_id;
+    double frame_budget_ms;
+
+    // time from creating the board to its first frame, time between presented frames and time spent painting, reported when the session ends
+    QElapsedTimer setup_clock;
+    double first_frame_ms;
+    QElapsedTimer frame_clock;
+    TimingStats frame_times;
+    TimingStats paint_times;
+    long long dropped_frames;
+
+    // finds the areas of the board that have to be repainted after each step
+    DirtyTracker dirty;
+
+    // key presses and releases waiting for the next tick, timestamped with input_clock. The time from each to the frame that shows it is kept in input_latency.
+    InputQueue input;
+    QElapsedTimer input_clock;
+    TimingStats input_latency;
+
+    // every session is recorded into recording and saved when it ends, unless it was restored from a snapshot. While replaying, the controls come from replay_player instead of the keyboard.
+    Replay recording;
+    bool recording_active;
+    Replay replay;
+    ReplayPlayer replay_player;
+    bool replaying;
+
+    // memory that snapshots saved with F5 are written into, kept between saves
+    std::vector<unsigned char> snapshot_buffer;
+
+    // draws sprites from the atlas of every image in the game, scaled for the pixel ratio atlas_dpr. The atlas belongs to the AssetRegistry.
+    qreal atlas_dpr;
+    SpriteBatch sprites;
+
+    // true if the time spent in each phase over the last second is drawn over the board. Toggled with F3.
+    bool profile_overlay;
+
+    // true from the first press of F4 to the second, which writes the trace. The profiler only records while this or the overlay is on.
+    bool trace_recording;
+    std::vector<ProfileSummary> profile_summaries;
+
+    // true if the board is drawn by the software blitter into backbuffer and presented with one copy, false if the sprites are drawn with QPainter. Toggled with F2.
+    bool software_blit;
+    QImage backbuffer;
+
+    // the labels, lives and boss health bar, drawn once for the values they show. Redrawn when one of them changes.
+    QImage hud;
+    int hud_lives;
+    bool hud_boss_battle;
+    int hud_boss_health;
 };
 
 
@@ -0,0 +1,36 @@
+# Headless simulation core shared by the game and the command-line tools. It only needs the C++ standard library.
+
+CONFIG += c++11
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += $$PWD/gamestate.cpp \
+    $$PWD/entityarrays.cpp \
+    $$PWD/scriptedplayer.cpp \
+    $$PWD/timingstats.cpp \
+    $$PWD/screenlayout.cpp \
+    $$PWD/spriteblit.cpp \
+    $$PWD/simdpath.cpp \
+    $$PWD/profiler.cpp \
+    $$PWD/inputqueue.cpp \
+    $$PWD/replay.cpp \
+    $$PWD/snapshot.cpp \
+    $$PWD/randomgenerator.cpp \
+    $$PWD/formation.cpp \
+    $$PWD/hitmask.cpp
+
+HEADERS += $$PWD/gamestate.h \
+    $$PWD/entityarrays.h \
+    $$PWD/scriptedplayer.h \
+    $$PWD/timingstats.h \
+    $$PWD/screenlayout.h \
+    $$PWD/spriteblit.h \
+    $$PWD/simdpath.h \
+    $$PWD/profiler.h \
+    $$PWD/inputqueue.h \
+    $$PWD/replay.h \
+    $$PWD/snapshot.h \
+    $$PWD/randomgenerator.h \
+    $$PWD/formation.h \
+    $$PWD/hitmask.h
@@ -0,0 +1,1011 @@
+/** @file gamestate.cpp
+ * @brief Contains implementation of GameState class. This class contains the rules of the game and advances them in fixed time steps.
+ *
+ * Every QTimer that used to drive the game is replaced by a SimTimer that is advanced once per tick, so a session can run at any speed.
+ */
+
+#include "gamestate.h"
+#include "profiler.h"
+#include "replay.h"
+#include <algorithm>
+#include <chrono>
+
+// time between two moves of the bullets, and the rows the bullets of each side are fired from and removed at
+static const int bullet_step_ms = 10;
+static const int enemy_top = 40;
+static const int player_top = 410;
+static const int bottom_edge = 550;
+
+// limits of the settings that valid_params() accepts. They are far beyond every preset: an hour between timer timeouts, a formation of 1000 by 1000 and 10000 of anything else.
+static const int max_setting_interval = 3600000;
+static const int max_formation_side = 1000;
+static const int max_setting_count = 10000;
+
+
+/** Returns a seed taken from the clock, so that sessions that are not replayed differ from each other.
+ */
+std::uint64_t random_seed() {
+    return std::chrono::system_clock::now().time_since_epoch().count();
+}
+
+
+/** Returns the difficulty settings of one of the presets on the level select screen.
+ * @param difficulty is 1 for easy, 2 for medium, 3 for hard, 4 for impossible and 5 for stress
+ * @return the settings of the preset. Unknown difficulties return the easy preset.
+ */
+GameParams preset_params(int difficulty) {
+
+    // In the order they are initialized, they are: enemy speed, enemy fire rate, boss speed, boss fire rate, boss health, formation columns, rows and spacing, enemy volley, and lives.
+    // The stress preset fires 3 enemy bullets every tick, 600 per second, and a boss volley of 3 bullets every 4 ticks, 150 per second. Its extra lives keep a session going long enough to measure.
+    switch (difficulty) {
+    case 2: return GameParams{550,400,30,750,25,10,3,50,1,3};
+    case 3: return GameParams{500,200,20,400,30,10,3,50,1,3};
+    case 4: return GameParams{450,100,10,300,40,10,3,50,1,3};
+    case stress_difficulty: return GameParams{600,5,10,20,200,100,30,6,3,15};
+    default: return GameParams{600,600,30,1000,20,10,3,50,1,3};
+    }
+}
+
+
+/** Returns the largest number of bullets of one kind that can be on screen at once: every volley fired during the longest time a bullet can live, plus one more.
+ * @param volley is the number of bullets fired at once
+ * @param interval_ms is the shortest time between two volleys
+ * @param distance is the farthest a bullet travels before it is removed, in pixels
+ * @param speed is the distance the bullet moves per bullet step, in pixels
+ */
+static std::size_t bullets_alive(int volley, int interval_ms, int distance, int speed) {
+    const int life_ms = (distance / speed + 2) * bullet_step_ms;
+    return static_cast<std::size_t>(volley) * (life_ms / std::max(interval_ms, 1) + 2);
+}
+
+
+/** Returns the largest number of each kind of entity that can be alive at once in a session. Every container of a GameState is reserved to this size when a session starts.
+ * @param params are the settings of the session
+ * @return the capacity of each container
+ */
+EntityCounts pool_capacity(const GameParams& params) {
+    EntityCounts pools;
+    pools.enemies = static_cast<std::size_t>(params.formation_columns) * params.formation_rows;
+
+    // the player fires at most once per 300 ms, enemies fire from the top row down at least, and the boss fires from the top
+    pools.player_bullets = bullets_alive(1, 300, player_top, -bullet_velocity_y[player_shot]);
+    pools.enemy_bullets = bullets_alive(params.enemy_volley, params.enemy_fire_rate, bottom_edge - enemy_top, bullet_velocity_y[enemy_shot]);
+    pools.boss_bullets = bullets_alive(3, params.boss_fire_rate, bottom_edge - enemy_top, bullet_velocity_y[boss_shot_left]);
+
+    // each enemy explodes once, and the player at most once per life and when the last one is lost
+    pools.explosions = pools.enemies + params.lives + 1;
+    return pools;
+}
+
+
+/** Counts the entities of a spawn that do not fit in the capacity of their container. They are spawned anyway, so a wrong
+ * capacity never changes how a session plays, and GameState::get_overflows() reports it.
+ * @param overflows is the count of the container
+ * @param size is the number of live entities in the container before the spawn
+ * @param spawned is the number of entities spawned
+ * @param capacity is the capacity of the container
+ */
+static void count_overflow(std::size_t& overflows, std::size_t size, std::size_t spawned, std::size_t capacity) {
+    if (size + spawned > capacity)
+        overflows += std::min(spawned, size + spawned - capacity);
+}
+
+
+/** Returns the name of one of the presets on the level select screen.
+ * @param difficulty is 1 for easy, 2 for medium, 3 for hard, 4 for impossible and 5 for stress
+ * @return the name shown on the preset's button in lower case
+ */
+const char* preset_name(int difficulty) {
+    switch (difficulty) {
+    case 2: return "medium";
+    case 3: return "hard";
+    case 4: return "impossible";
+    case stress_difficulty: return "stress";
+    default: return "easy";
+    }
+}
+
+
+/** Finds the preset a session was started with, e.g. one restored from a snapshot, so that retrying it plays the same difficulty.
+ * @param params are the settings of the session
+ * @return 1 for easy, 2 for medium, 3 for hard, 4 for impossible, 5 for stress, or 0 if the settings are not those of a preset
+ */
+int preset_of(const GameParams& params) {
+    for (int difficulty = 1; difficulty <= stress_difficulty; ++difficulty) {
+        const GameParams preset = preset_params(difficulty);
+        if (preset.enemy_speed == params.enemy_speed && preset.enemy_fire_rate == params.enemy_fire_rate
+            && preset.boss_speed == params.boss_speed && preset.boss_fire_rate == params.boss_fire_rate
+            && preset.boss_health == params.boss_health && preset.formation_columns == params.formation_columns
+            && preset.formation_rows == params.formation_rows && preset.formation_spacing == params.formation_spacing
+            && preset.enemy_volley == params.enemy_volley && preset.lives == params.lives)
+            return difficulty;
+    }
+    return 0;
+}
+
+
+/** Returns true if settings read from a file can be played: every interval is positive, so no timer times out forever, and
+ * the formation, volleys, health and lives are small enough that the pools of the session fit in memory.
+ * @param params are the settings to check
+ */
+bool valid_params(const GameParams& params) {
+    const int intervals[] = { params.enemy_speed, params.enemy_fire_rate, params.boss_speed, params.boss_fire_rate };
+    for (int interval : intervals) {
+        if (interval < 1 || interval > max_setting_interval)
+            return false;
+    }
+    return params.boss_health >= 1 && params.boss_health <= max_setting_count
+           && params.formation_columns >= 0 && params.formation_columns <= max_formation_side
+           && params.formation_rows >= 0 && params.formation_rows <= max_formation_side
+           && params.formation_spacing >= 1 && params.formation_spacing <= max_formation_side
+           && params.enemy_volley >= 0 && params.enemy_volley <= max_setting_count
+           && params.lives >= 0 && params.lives <= max_setting_count;
+}
+
+
+/** Constructor for SimTimer. The timer is created stopped.
+ * @param new_interval is the time between timeouts in milliseconds
+ * @param new_single_shot is true if the timer should stop after its first timeout
+ */
+SimTimer::SimTimer(int new_interval, bool new_single_shot) :
+    interval(new_interval), elapsed(0), active(false), single_shot(new_single_shot)
+{
+}
+
+
+/** Starts or restarts the timer.
+ */
+void SimTimer::start() {
+    elapsed = 0;
+    active = true;
+}
+
+
+/** Stops the timer.
+ */
+void SimTimer::stop() {
+    elapsed = 0;
+    active = false;
+}
+
+
+/** Advances the timer by the given amount of simulation time. Does nothing if the timer is stopped.
+ * @param dt is the elapsed time in milliseconds
+ */
+void SimTimer::advance(int dt) {
+    if (active)
+        elapsed += dt;
+}
+
+
+/** Consumes one timeout of the timer. Call repeatedly after advance() until it returns false.
+ * @return true if the timer timed out
+ */
+bool SimTimer::timeout() {
+    if (!active || elapsed < interval)
+        return false;
+
+    elapsed -= interval;
+    if (single_shot)
+        stop();
+    return true;
+}
+
+
+
+/** Contructor for GameState. Starts a session with the given settings.
+ * @param params are the difficulty settings of the session
+ * @param new_seed is the seed of the random number generator. Two sessions with the same settings, seed and controls play out the same.
+ */
+GameState::GameState(const GameParams& params, std::uint64_t new_seed) :
+    recorder(nullptr)
+{
+    reset(params, new_seed);
+}
+
+
+/** Starts a new session with the given settings. Initializes all timers and variables necessary to make the game work. Containers
+ * are emptied but keep their memory, so a state that is reused for many sessions stops allocating once it has grown to size.
+ * @param new_params are the difficulty settings of the session
+ * @param new_seed is the seed of the random number generator
+ */
+void GameState::reset(const GameParams& new_params, std::uint64_t new_seed) {
+    params = new_params;
+    seed = new_seed;
+    generator.seed(seed);
+    reserve_pools();
+    accumulator = 0;
+    ticks = 0;
+    outcome = GameOutcome::Playing;
+    peak_counts = EntityCounts();
+    overflows = EntityCounts();
+
+    // nothing has collided yet
+    bullet_step = false;
+    enemies_hit = false;
+    player_was_hit = false;
+    boss_hits = 0;
+    dead_enemies.clear();
+    dead_player_bullets.clear();
+    dead_enemy_bullets.clear();
+    dead_boss_bullets.clear();
+
+    // all timers are stopped until they are started below or by the game
+    explosion_timer = SimTimer(50);
+    boss_explosion_timer = SimTimer(100);
+    boss_battle_timer = SimTimer(2000);
+    game_over_timer = SimTimer(2000, true);
+    win_message_timer = SimTimer(2000);
+    move_timer = SimTimer(15);
+    shoot_timer = SimTimer(300, true);
+    respawn_timer = SimTimer(2000);
+    enemy_timer = SimTimer(params.enemy_speed);
+    bullet_timer = SimTimer(bullet_step_ms);
+    enemy_fire_bullet_timer = SimTimer(params.enemy_fire_rate);
+    boss_move_timer = SimTimer(params.boss_speed);
+    boss_fire_rate_timer = SimTimer(params.boss_fire_rate);
+
+    // remove everything left over from a previous session
+    explosion_locations.clear();
+    player_bullets.clear();
+    enemy_bullets.clear();
+    boss_bullets.clear();
+
+    // initialize the formation of enemies with every cell alive
+    enemies.reset(params.formation_columns, params.formation_rows, 30, enemy_top, params.formation_spacing, params.formation_spacing, capacity.enemies);
+
+    // set initial player position
+    player_position = std::make_pair(350,player_top);
+
+    // set initial boss position
+    boss_position = std::make_pair(250,40);
+
+    // set initial lives
+    lives_count = params.lives;
+
+    // enemies initially moving right
+    moving_right = true;
+
+    // player is initially alive
+    alive = true;
+
+    // boss initially moves right
+    boss_moving_right = true;
+
+    // boss battle has not occurred yet, so set variables related to boss to false
+    boss_message = false;
+    start_boss_battle = false;
+    boss_alive = false;
+    win_message = false;
+    boss_explosion_location = std::make_pair(std::make_pair(-50,-50), 0);
+
+    // set initial boss health
+    boss_health = params.boss_health;
+    total_boss_health = params.boss_health;
+
+    // timers that run from the start of the game
+    move_timer.start();
+    enemy_timer.start();
+    bullet_timer.start();
+    explosion_timer.start();
+    enemy_fire_bullet_timer.start();
+}
+
+
+/** Reserves every container for the capacity of the session's settings. Containers only grow, so a state reused for sessions of several presets keeps the largest of them and stops allocating.
+ */
+void GameState::reserve_pools() {
+    capacity = pool_capacity(params);
+    enemies.reserve(params.formation_columns, params.formation_rows);
+    player_bullets.reserve(capacity.player_bullets);
+    enemy_bullets.reserve(capacity.enemy_bullets);
+    boss_bullets.reserve(capacity.boss_bullets);
+    explosion_locations.reserve(capacity.explosions);
+
+    dead_enemies.reserve(capacity.player_bullets);
+    dead_player_bullets.reserve(capacity.player_bullets);
+    dead_enemy_bullets.reserve(capacity.enemy_bullets);
+    dead_boss_bullets.reserve(capacity.boss_bullets);
+
+    hit_masks.reserve(hit_mask_words(std::max(capacity.player_bullets, std::max(capacity.enemy_bullets, capacity.boss_bullets))));
+}
+
+
+/** Advances the simulation by the given amount of time. Time is consumed in fixed ticks of tick_ms milliseconds; any remainder is carried over to the next call.
+ * @param dt is the elapsed time in milliseconds
+ * @param input is the state of the player's controls during this time
+ * @return the number of ticks that were run
+ */
+int GameState::step(int dt, const GameInput& input) {
+    accumulator += dt;
+
+    int ticks_run = 0;
+    while (accumulator >= tick_ms && outcome == GameOutcome::Playing) {
+        tick(input);
+        accumulator -= tick_ms;
+        ++ticks_run;
+    }
+
+    return ticks_run;
+}
+
+
+/** Advances the simulation by the given amount of time like the other step(), but takes the controls from a source such as a queue of key presses or a replay. The source is consumed at the start of every tick, so each tick sees every key change that happened before it.
+ * @param dt is the elapsed time in milliseconds
+ * @param input provides the controls of each tick
+ * @return the number of ticks that were run
+ */
+int GameState::step(int dt, InputSource& input) {
+    accumulator += dt;
+
+    int ticks_run = 0;
+    GameInput controls;
+    while (accumulator >= tick_ms && outcome == GameOutcome::Playing) {
+        input.consume(controls);
+        tick(controls);
+        accumulator -= tick_ms;
+        ++ticks_run;
+    }
+
+    return ticks_run;
+}
+
+
+/** Runs a single fixed step of tick_ms milliseconds. Every step runs the same phases in the same order: integrate moves everything whose timer timed out, collide finds every overlap, resolve removes what collided and applies the consequences, and spawn fires new bullets. Headless drivers may call this directly instead of step().
+ * @param input is the state of the player's controls during this tick
+ */
+void GameState::tick(const GameInput& input) {
+    ProfileScope scope("tick");
+
+    if (recorder)
+        recorder->record(input);
+    ++ticks;
+
+    advance_timers();
+    integrate(input);
+    collide();
+    resolve();
+    spawn(input);
+
+    update_peak_counts();
+}
+
+
+/** Advances every timer by one tick. The phases then consume the timeouts of the timers they own.
+ */
+void GameState::advance_timers() {
+    move_timer.advance(tick_ms);
+    shoot_timer.advance(tick_ms);
+    respawn_timer.advance(tick_ms);
+    enemy_timer.advance(tick_ms);
+    bullet_timer.advance(tick_ms);
+    enemy_fire_bullet_timer.advance(tick_ms);
+    boss_move_timer.advance(tick_ms);
+    boss_fire_rate_timer.advance(tick_ms);
+    explosion_timer.advance(tick_ms);
+    boss_explosion_timer.advance(tick_ms);
+    boss_battle_timer.advance(tick_ms);
+    win_message_timer.advance(tick_ms);
+    game_over_timer.advance(tick_ms);
+}
+
+
+/** First phase of a tick. Moves the player, enemies, boss and bullets and advances explosion animations.
+ * @param input is the state of the player's controls during this tick
+ */
+void GameState::integrate(const GameInput& input) {
+    while (move_timer.timeout())
+        move_player(input);
+
+    while (enemy_timer.timeout())
+        move_enemies();
+
+    while (boss_move_timer.timeout())
+        move_boss();
+
+    // bullets move on their own timer, and collisions are only checked on ticks where bullets moved. The bullet interval is longer than a tick, so this happens at most once per tick.
+    bullet_step = false;
+    while (bullet_timer.timeout()) {
+        move_bullets();
+        move_boss_bullet();
+        bullet_step = true;
+    }
+
+    while (explosion_timer.timeout())
+        draw_explosion();
+
+    while (boss_explosion_timer.timeout())
+        draw_boss_explosion();
+}
+
+
+/** Second phase of a tick. Marks every bullet, enemy and player that collided, without removing anything yet.
+ */
+void GameState::collide() {
+    enemies_hit = false;
+    player_was_hit = false;
+    boss_hits = 0;
+
+    if (!bullet_step)
+        return;
+
+    dead_enemies.clear();
+    dead_player_bullets.assign(player_bullets.size(), 0);
+    dead_enemy_bullets.assign(enemy_bullets.size(), 0);
+    dead_boss_bullets.assign(boss_bullets.size(), 0);
+
+    remove_enemy();
+    player_hit();
+    player_hit_boss();
+    boss_hit();
+}
+
+
+/** Third phase of a tick. Removes everything that collided in one pass per container, applies lost lives and boss damage, and runs the timers that move the game from one stage to the next.
+ */
+void GameState::resolve() {
+
+    // enemies that were hit turn into explosions, column by column from the left
+    if (enemies_hit) {
+        std::sort(dead_enemies.begin(), dead_enemies.end());
+        const int rows = enemies.get_rows();
+        for (int cell : dead_enemies) {
+            const int column = cell / rows;
+            const int row = cell % rows;
+            count_overflow(overflows.explosions, explosion_locations.size(), 1, capacity.explosions);
+            explosion_locations.push_back(std::make_pair(std::make_pair(enemies.column_x(column), enemies.row_y(row)), 0));
+            enemies.kill(column, row);
+        }
+    }
+
+    // player bullets that hit an enemy or the boss
+    if (enemies_hit || boss_hits > 0)
+        player_bullets.remove_if([this](size_t i) { return dead_player_bullets[i] != 0; });
+
+    // enemy and boss bullets that hit the player. The player only loses one life no matter how many bullets hit at once.
+    if (player_was_hit) {
+        enemy_bullets.remove_if([this](size_t i) { return dead_enemy_bullets[i] != 0; });
+        boss_bullets.remove_if([this](size_t i) { return dead_boss_bullets[i] != 0; });
+        kill_player();
+    }
+
+    // each bullet that hit the boss takes away one health
+    if (boss_hits > 0)
+        boss_health = boss_hits < boss_health ? boss_health - boss_hits : 0;
+
+    // if boss has no health left, then set boss explosion location to boss's current location
+    if (bullet_step && boss_alive && boss_health == 0)
+        boss_explosion_location = std::make_pair(boss_position,0);
+
+    while (respawn_timer.timeout())
+        respawn();
+
+    while (boss_battle_timer.timeout())
+        boss_battle_message();
+
+    while (win_message_timer.timeout() && outcome == GameOutcome::Playing)
+        win_message_appear();
+
+    if (game_over_timer.timeout() && outcome == GameOutcome::Playing)
+        outcome = GameOutcome::Lost;
+
+    check_progress();
+}
+
+
+/** Last phase of a tick. Fires new bullets from the player, the enemies and the boss.
+ * @param input is the state of the player's controls during this tick
+ */
+void GameState::spawn(const GameInput& input) {
+    shoot_timer.timeout();
+    if (input.fire)
+        fire_player_bullet();
+
+    while (enemy_fire_bullet_timer.timeout())
+        enemy_fire_bullet();
+
+    while (boss_fire_rate_timer.timeout())
+        boss_fire_bullet();
+}
+
+
+/** Removes every enemy, bullet and explosion, so that a benchmark or stress test can place its own. Timers and the stage of the game are left as they are.
+ */
+void GameState::clear_entities() {
+    explosion_locations.clear();
+    player_bullets.clear();
+    enemy_bullets.clear();
+    boss_bullets.clear();
+    enemies.clear();
+}
+
+
+/** Replaces the enemies with a formation of the given layout, e.g. one larger than any preset.
+ * @param columns is the number of columns
+ * @param rows is the number of rows
+ * @param left is the x coordinate of the first column
+ * @param top is the y coordinate of the first row
+ * @param pitch_x is the distance between neighbouring columns
+ * @param pitch_y is the distance between neighbouring rows
+ * @param count is the number of live enemies, which fill the formation column by column from the left
+ */
+void GameState::spawn_formation(int columns, int rows, int left, int top, int pitch_x, int pitch_y, std::size_t count) {
+    enemies.reset(columns, rows, left, top, pitch_x, pitch_y, count);
+}
+
+
+/** Adds a bullet to the container of its owner: the player, the enemies or the boss.
+ * @param x is the x coordinate of the bullet
+ * @param y is the y coordinate of the bullet
+ * @param kind is the type of the bullet, which decides its owner and velocity
+ */
+void GameState::spawn_bullet(int x, int y, BulletKind kind) {
+    if (kind == player_shot)
+        player_bullets.push(x, y, kind);
+    else if (kind == enemy_shot)
+        enemy_bullets.push(x, y, kind);
+    else
+        boss_bullets.push(x, y, kind);
+}
+
+
+/** Adds an explosion.
+ * @param x is the x coordinate of the explosion
+ * @param y is the y coordinate of the explosion
+ * @param frame is the frame of the animation, from 0 to 13
+ */
+void GameState::spawn_explosion(int x, int y, int frame) {
+    explosion_locations.push_back(std::make_pair(std::make_pair(x, y), frame));
+}
+
+
+/** Runs one part of a tick on its own. The collision kernels start from no entity being marked, as they do in collide(), and only mark what collided; nothing is removed until the next resolve().
+ * @param kernel is the part to run
+ */
+void GameState::run_kernel(GameKernel kernel) {
+    if (kernel == kernel_remove_enemy || kernel == kernel_player_hit || kernel == kernel_player_hit_boss || kernel == kernel_boss_hit) {
+        dead_enemies.clear();
+        dead_player_bullets.assign(player_bullets.size(), 0);
+        dead_enemy_bullets.assign(enemy_bullets.size(), 0);
+        dead_boss_bullets.assign(boss_bullets.size(), 0);
+    }
+
+    switch (kernel) {
+    case kernel_move_enemies: move_enemies(); break;
+    case kernel_move_bullets: move_bullets(); break;
+    case kernel_move_boss_bullet: move_boss_bullet(); break;
+    case kernel_remove_enemy: remove_enemy(); break;
+    case kernel_player_hit: player_hit(); break;
+    case kernel_player_hit_boss: player_hit_boss(); break;
+    case kernel_boss_hit: boss_hit(); break;
+    case kernel_draw_explosion: draw_explosion(); break;
+    }
+}
+
+
+/** Mixes values into a 64 bit FNV-1a hash.
+ */
+static void hash_values(std::uint64_t& hash, const int* values, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        std::uint32_t value = static_cast<std::uint32_t>(values[i]);
+        for (int byte = 0; byte < 4; ++byte, value >>= 8) {
+            hash ^= value & 0xff;
+            hash *= 1099511628211ULL;
+        }
+    }
+}
+
+
+/** Returns a hash of everything that decides how the session continues: the tick, positions, lives, health and every entity. Two states
+ * with the same checksum are the same for all practical purposes, so a replay can check that it reproduced the recorded session.
+ */
+std::uint64_t GameState::checksum() const {
+    std::uint64_t hash = 14695981039346656037ULL;
+
+    const int fields[] = { static_cast<int>(ticks), static_cast<int>(ticks >> 32), static_cast<int>(outcome), lives_count, alive, boss_health, boss_alive,
+                           start_boss_battle, player_position.first, player_position.second, boss_position.first, boss_position.second, moving_right, boss_moving_right };
+    hash_values(hash, fields, sizeof(fields) / sizeof(fields[0]));
+
+    const int formation[] = { enemies.get_columns(), enemies.get_rows(), enemies.get_left(), enemies.get_top(), enemies.get_pitch_x(), enemies.get_pitch_y() };
+    hash_values(hash, formation, sizeof(formation) / sizeof(formation[0]));
+    for (std::uint64_t mask : enemies.get_row_masks()) {
+        const int words[] = { static_cast<int>(mask), static_cast<int>(mask >> 32) };
+        hash_values(hash, words, 2);
+    }
+    const BulletArray* bullets[] = { &player_bullets, &enemy_bullets, &boss_bullets };
+    for (const BulletArray* array : bullets) {
+        hash_values(hash, array->x.data(), array->size());
+        hash_values(hash, array->y.data(), array->size());
+    }
+    for (const auto& x : explosion_locations) {
+        const int explosion[] = { x.first.first, x.first.second, x.second };
+        hash_values(hash, explosion, 3);
+    }
+    return hash;
+}
+
+
+/** Records the number of live entities in each container if it is the highest seen so far.
+ */
+void GameState::update_peak_counts() {
+    peak_counts.enemies = std::max(peak_counts.enemies, enemies.size());
+    peak_counts.player_bullets = std::max(peak_counts.player_bullets, player_bullets.size());
+    peak_counts.enemy_bullets = std::max(peak_counts.enemy_bullets, enemy_bullets.size());
+    peak_counts.boss_bullets = std::max(peak_counts.boss_bullets, boss_bullets.size());
+    peak_counts.explosions = std::max(peak_counts.explosions, explosion_locations.size());
+}
+
+
+/** Moves the player left or right depending on which keys are held down.
+ * @param input is the state of the player's controls
+ */
+void GameState::move_player(const GameInput& input) {
+    if (input.left) {
+        if (player_position.first > 10)
+            player_position.first -= 5;
+    }
+
+    if (input.right) {
+        if (player_position.first < 680)
+            player_position.first += 5;
+    }
+}
+
+
+/** Fires a bullet from the player's position.
+ */
+void GameState::fire_player_bullet() {
+
+    // if shoot timer is active, then player won't be able to fire. This sets the fastest fire rate of the player.
+    if (!shoot_timer.active) {
+        count_overflow(overflows.player_bullets, player_bullets.size(), 1, capacity.player_bullets);
+        player_bullets.push(player_position.first, player_position.second, player_shot);
+        shoot_timer.start();
+    }
+}
+
+
+/** Starts the timers that lead to the boss battle, the win message or the game over screen once their conditions are met.
+ */
+void GameState::check_progress() {
+
+    // if boss battle is taking place
+    if (start_boss_battle) {
+
+        // if boss is dead, start two timers that will display the win message and an explosion animation
+        if (boss_health == 0) {
+            if (!win_message_timer.active)
+                win_message_timer.start();
+            if (!boss_explosion_timer.active)
+                boss_explosion_timer.start();
+
+            boss_alive = false;
+        }
+
+        // if player has 0 lives, then start a timer that will display the game over screen
+        if (lives_count < 1) {
+            if (!game_over_timer.active)
+                game_over_timer.start();
+        }
+    }
+
+    // when all enemies have been defeated but the boss has not appeared yet
+    else if (enemies.empty()) {
+
+        // start timer that will display the "boss battle" message and start the boss battle
+        if (!boss_battle_timer.active)
+            boss_battle_timer.start();
+
+        // it is still possible for a player to be hit by a bullet after all enemies have been defeated
+        if (lives_count < 1) {
+            if (!game_over_timer.active)
+                game_over_timer.start();
+        }
+    }
+
+    // if player has 0 lives or the lowest row of enemies reaches the botton of the screen, start a timer that will display game over screen
+    else if (lives_count < 1 || enemies.row_y(enemies.last_row()) > 400) {
+        if (!game_over_timer.active)
+            game_over_timer.start();
+    }
+}
+
+
+/** Move the boss from side to side.
+ */
+void GameState::move_boss() {
+
+    // if boss is moving right and has not reached the far right of the screen, move it right
+    if (boss_position.first + 20 < 700 && boss_moving_right) {
+        boss_position.first += 3;
+    }
+
+    // if boss is at far right, then switch directions
+    else if (boss_position.first + 20 >= 700 && boss_moving_right) {
+        boss_moving_right = false;
+    }
+
+    // if boss is moving left is has not reached the far left of the screen, move it left
+    else if (boss_position.first > 0 && !boss_moving_right) {
+        boss_position.first -= 3;
+    }
+
+    // if boss is at far left, then switch directions
+    else if (boss_position.first <= 0 && !boss_moving_right) {
+        boss_moving_right = true;
+    }
+}
+
+
+
+/** Move the enemies side to side.
+ */
+void GameState::move_enemies() {
+
+    // if enemies are present. The whole formation moves with its origin, and its edges are its leftmost and rightmost live columns.
+    if (!enemies.empty()) {
+        const int right = enemies.column_x(enemies.last_column());
+        const int left = enemies.column_x(enemies.first_column());
+
+        // if enemies are moving right and rightmost enemy has not reached the far right of the screen, move enemies right
+        if (right + 20 < 700 && moving_right) {
+            enemies.move(20, 0);
+        }
+
+        // if rightmost enemy is at far right of screen, then move enemies down and change directions
+        else if (right + 20 >= 700 && moving_right) {
+            enemies.move(0, 20);
+            moving_right = false;
+        }
+
+        // if enemies are moving left and leftmost enemy has not reached the far left of the screen, move enemies left
+        else if (left - 20 > 0 && !moving_right) {
+            enemies.move(-20, 0);
+        }
+
+        // if leftmost enemy is at far left of screen, then move enemies down and change directions
+        else if (left - 20 <= 0 && !moving_right) {
+            enemies.move(0, 20);
+            moving_right = true;
+        }
+    }
+}
+
+
+/** Move player's and enemies' bullets. Also remove every bullet that has gone offscreen.
+ */
+void GameState::move_bullets() {
+    ProfileScope scope("move_bullets");
+
+    // move each of the player's bullets up and each of the enemies' bullets down
+    player_bullets.integrate();
+    enemy_bullets.integrate();
+
+    // remove player's bullets that reached the top of the screen and enemies' bullets that reached the bottom of the screen
+    player_bullets.remove_if([this](size_t i) { return player_bullets.y[i] < 0; });
+    enemy_bullets.remove_if([this](size_t i) { return enemy_bullets.y[i] > bottom_edge; });
+}
+
+/** Randomly fires a volley of bullets from enemies. Each bullet starts at the position of a randomly selected enemy.
+ */
+void GameState::enemy_fire_bullet() {
+
+    // if enemies present, then select an enemy at random for each bullet and fire it from its location
+    if (!enemies.empty()) {
+        const std::uint32_t enemy_count = static_cast<std::uint32_t>(enemies.size());
+        count_overflow(overflows.enemy_bullets, enemy_bullets.size(), static_cast<std::size_t>(params.enemy_volley), capacity.enemy_bullets);
+        for (int i = 0; i < params.enemy_volley; ++i) {
+            int column = 0;
+            int row = 0;
+            enemies.find(generator.below(enemy_count), column, row);
+            enemy_bullets.push(enemies.column_x(column), enemies.row_y(row), enemy_shot);
+        }
+    }
+}
+
+
+/** Fires bullets from boss. The boss fires three bullets at a time: one moving at a 45 degree angle to the left, one moving straight down, and one moving at a 45 degree angle to the right. The direction of each bullet is stored as its kind.
+ */
+void GameState::boss_fire_bullet() {
+
+    // boss fires one of each type of bullet at a time
+    if (boss_alive) {
+        count_overflow(overflows.boss_bullets, boss_bullets.size(), 3, capacity.boss_bullets);
+        boss_bullets.push(boss_position.first, boss_position.second, boss_shot_left);
+        boss_bullets.push(boss_position.first, boss_position.second, boss_shot_down);
+        boss_bullets.push(boss_position.first, boss_position.second, boss_shot_right);
+    }
+}
+
+
+/** Move boss bullets down or diagonally depending on the kind of bullet. Also removes every bullet that has gone offscreen.
+ */
+void GameState::move_boss_bullet() {
+    ProfileScope scope("move_boss_bullet");
+
+    // each bullet moves by the velocity of its kind
+    boss_bullets.integrate();
+
+    // remove bullets that reached the bottom or sides of the screen
+    boss_bullets.remove_if([this](size_t i) { return boss_bullets.y[i] > bottom_edge || boss_bullets.x[i] < 10 || boss_bullets.x[i] > 700; });
+}
+
+
+/** This function detects collisions between player bullets and enemies. Marks every enemy and bullet that collided for removal by resolve(). Each bullet destroys at most one enemy, and only the live cells of the formation that overlap each bullet are tested.
+ */
+void GameState::remove_enemy() {
+    ProfileScope scope("remove_enemy");
+
+    if (enemies.empty() || player_bullets.empty())
+        return;
+
+    // checks each bullet with the enemies whose positions overlap it, which are those less than 20 pixels to either side and 11 above or below.
+    // The last of them in column order that has not been hit yet is marked for removal along with the bullet.
+    const int rows = enemies.get_rows();
+    for (size_t i = 0, n = player_bullets.size(); i < n; ++i) {
+        const int bx = player_bullets.x[i];
+        const int by = player_bullets.y[i];
+        int hit = -1;
+        enemies.for_each_near(bx-19, bx+19, by-10, by+10, [&](int column, int row) {
+            const int cell = column*rows + row;
+            if (cell > hit && std::find(dead_enemies.begin(), dead_enemies.end(), cell) == dead_enemies.end())
+                hit = cell;
+        });
+
+        if (hit >= 0) {
+            enemies_hit = true;
+            dead_enemies.push_back(hit);
+            dead_player_bullets[i] = 1;
+        }
+    }
+}
+
+
+/** Checks for collisions between enemy bullets and player. Marks every bullet that hit the player for removal by resolve().
+ */
+void GameState::player_hit() {
+    ProfileScope scope("player_hit");
+
+    if (enemy_bullets.empty())
+        return;
+
+    // compares every enemy bullet with the player to see if their positions overlap. If they do, then marks the bullet for removal
+    const HitBox player_box = { player_position.first-15, player_position.second-10, player_position.first+15, player_position.second+10 };
+    hit_masks.resize(hit_mask_words(enemy_bullets.size()));
+    if (mark_points_in_box(enemy_bullets.x.data(), enemy_bullets.y.data(), enemy_bullets.size(), player_box, hit_masks.data())) {
+        player_was_hit = true;
+        for_each_hit(hit_masks.data(), enemy_bullets.size(), [this](size_t i) { dead_enemy_bullets[i] = 1; });
+    }
+}
+
+
+/** Checks for collisions between boss bullets and player. Marks every boss bullet that hit the player for removal by resolve().
+ */
+void GameState::player_hit_boss() {
+    ProfileScope scope("player_hit_boss");
+
+    if (boss_bullets.empty())
+        return;
+
+    // compares every boss bullet with the player to see if their positions overlap. If they do, then marks the bullet for removal
+    const HitBox player_box = { player_position.first-15, player_position.second-10, player_position.first+15, player_position.second+10 };
+    hit_masks.resize(hit_mask_words(boss_bullets.size()));
+    if (mark_points_in_box(boss_bullets.x.data(), boss_bullets.y.data(), boss_bullets.size(), player_box, hit_masks.data())) {
+        player_was_hit = true;
+        for_each_hit(hit_masks.data(), boss_bullets.size(), [this](size_t i) { dead_boss_bullets[i] = 1; });
+    }
+}
+
+
+/** Called when the player has been hit by a bullet. Decrements lives count, adds an explosion and starts the respawn timer.
+ */
+void GameState::kill_player() {
+
+    // add explosion to explosion locations vector
+    count_overflow(overflows.explosions, explosion_locations.size(), 1, capacity.explosions);
+    explosion_locations.push_back(std::make_pair(player_position, 0));
+
+    // decrement lives count
+    --lives_count;
+    alive = false;
+
+    // temporarily move player off screen while player respawns
+    player_position = std::make_pair(-50,-50);
+
+    // start respawn timer
+    respawn_timer.start();
+}
+
+
+/** Checks for collisions between player bullets and boss. Marks every player bullet that hit the boss and has not already hit an enemy, and counts the hits for resolve().
+ */
+void GameState::boss_hit() {
+    ProfileScope scope("boss_hit");
+
+    // compares every player bullet with the boss to see if their positions overlap. If they do, then marks the bullet for removal
+    if (boss_alive && !player_bullets.empty()) {
+        const HitBox boss_box = { boss_position.first-50, boss_position.second-30, boss_position.first+50, boss_position.second+30 };
+        hit_masks.resize(hit_mask_words(player_bullets.size()));
+        if (mark_points_in_box(player_bullets.x.data(), player_bullets.y.data(), player_bullets.size(), boss_box, hit_masks.data())) {
+            for_each_hit(hit_masks.data(), player_bullets.size(), [this](size_t i) {
+                if (!dead_player_bullets[i]) {
+                    ++boss_hits;
+                    dead_player_bullets[i] = 1;
+                }
+            });
+        }
+    }
+}
+
+/** Advances explosions for players and enemies. Explosion locations are stored in a vector of std::pairs, where the first element is itself an std::pair that stores the x and y coordinates of the explosion, and the second element is an integer between 0 and 13 that indicates which frame of the explosion is being displayed. This function increments the second element for each object, which advances the explosion animation to the next frame. It also removes every explosion whose 14 frames have all been displayed.
+ */
+void GameState::draw_explosion() {
+    ProfileScope scope("draw_explosion");
+
+    // remove explosions once their animation is finished
+    explosion_locations.erase(std::remove_if(explosion_locations.begin(), explosion_locations.end(), [](const std::pair<std::pair<int,int>, int>& x) { return x.second >= explosion_frames - 1; }), explosion_locations.end());
+
+    // increment integer representing explosion frame
+    for (auto& x : explosion_locations)
+        ++x.second;
+}
+
+
+/** Advances explosion for boss.
+ */
+void GameState::draw_boss_explosion() {
+    if (boss_explosion_location.second < explosion_frames - 1)
+
+        // increments explosion frame
+        ++boss_explosion_location.second;
+    else
+
+        // moves animation offscreen once it is finished
+        boss_explosion_location.first = std::make_pair(-50,-50);
+}
+
+
+/** This function is called after the player has been hit. It causes the player to reappear on screen and stops the respawn timer.
+ */
+void GameState::respawn() {
+    player_position = std::make_pair(350,player_top);
+    alive = true;
+    respawn_timer.stop();
+}
+
+/** After the final enemy is defeated, a timer connected to this function will start. This function will be called 2 times total. Before the first time the function is called, no message will be displayed but the player and bullets will still be displayed. This creates a delay before the appearance of the message. Once the function is called for the first time, it will display the "boss battle" message. The message will remain on screen for the duration of the timer interval until the function is called for the second time, which removes the message and starts the boss battle.
+ */
+void GameState::boss_battle_message() {
+
+    // if boss message is not displayed, then it will be displayed
+    if (boss_message == false)
+        boss_message = true;
+
+    // if boss message is already displayed, then it will be removed and the boss battle will start
+    else if (boss_message == true) {
+        boss_message = false;
+        start_boss_battle = true;
+        boss_alive = true;
+        boss_battle_timer.stop(); // stops the boss battle timer so function is only called twice
+        enemy_fire_bullet_timer.stop();
+        enemy_timer.stop();
+        boss_move_timer.start();
+        boss_fire_rate_timer.start();
+    }
+
+}
+
+/** This function operates similarly to GameState::boss_battle_message(). It will be called 2 times total and displays the win message after a delay. After the win message is displayed, the session is won.
+ */
+void GameState::win_message_appear() {
+
+    // if win message is not displayed, then it will be displayed
+    if (win_message == false)
+        win_message = true;
+
+    // if win message is already displayed, then the session is won
+    else if (win_message == true) {
+        win_message_timer.stop();
+        outcome = GameOutcome::Won;
+    }
+}
@@ -0,0 +1,344 @@
+/** @file gamestate.h
+ * @brief Contains declarations for the GameState class, the headless simulation core of the game.
+ *
+ * GameState holds everything needed to play a session and advances it in fixed time steps. It does not depend on Qt,
+ * so it can be stepped as fast as the CPU allows for testing, analysis and bots. Gameboard wraps it for input and painting.
+ */
+
+#ifndef GAMESTATE_H
+#define GAMESTATE_H
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "entityarrays.h"
+#include "formation.h"
+#include "hitmask.h"
+#include "randomgenerator.h"
+
+class Replay;
+
+
+
+/** @struct GameParams
+ * @brief Difficulty settings of a session. All times are in milliseconds.
+ */
+struct GameParams
+{
+    int enemy_speed;        // time between enemy movements
+    int enemy_fire_rate;    // time between enemy volleys
+    int boss_speed;         // time between boss movements
+    int boss_fire_rate;     // time between boss volleys
+    int boss_health;        // amount of hits required to defeat the boss
+    int formation_columns;  // number of columns of enemies at the start
+    int formation_rows;     // number of rows of enemies at the start
+    int formation_spacing;  // distance between neighbouring enemies, in pixels
+    int enemy_volley;       // number of bullets the enemies fire at once, each from a random enemy
+    int lives;              // lives at the start of the session
+};
+
+// difficulty presets offered on the level select screen. Difficulties are numbered from 1 (easy) to 4 (impossible).
+static const int preset_count = 4;
+
+// the stress preset, which follows the others: a formation of thousands of enemies firing hundreds of bullets per second, to find the limits of the game on real hardware
+static const int stress_difficulty = preset_count + 1;
+GameParams preset_params(int difficulty);
+const char* preset_name(int difficulty);
+
+// difficulty of the preset with exactly these settings, or 0 if they are not a preset's, e.g. to retry a session restored from a file
+int preset_of(const GameParams& params);
+
+// true if settings that were read from a file, e.g. a replay or a snapshot, are safe to play
+bool valid_params(const GameParams& params);
+
+// a seed that differs between runs, for sessions that do not have to be reproduced
+std::uint64_t random_seed();
+
+
+
+/** @struct GameInput
+ * @brief State of the player's controls for one call to GameState::step()
+ */
+struct GameInput
+{
+    bool left;
+    bool right;
+    bool fire;
+};
+
+
+
+/** @class InputSource
+ * @brief Provides the player's controls at the start of each tick, e.g. from the keyboard or from a recording
+ */
+class InputSource
+{
+public:
+    virtual ~InputSource() {}
+    virtual void consume(GameInput& input) = 0;
+};
+
+
+
+/** @struct SimTimer
+ * @brief Countdown timer driven by simulation time instead of the Qt event loop.
+ *
+ * Mirrors the parts of QTimer that the game uses: an interval, single shot mode, and start/stop.
+ */
+struct SimTimer
+{
+    int interval;
+    int elapsed;
+    bool active;
+    bool single_shot;
+
+    SimTimer(int new_interval = 0, bool new_single_shot = false);
+    void start();
+    void stop();
+    void advance(int dt);
+    bool timeout();
+};
+
+
+
+/** @struct EntityCounts
+ * @brief Number of live entities in each container of a GameState
+ */
+struct EntityCounts
+{
+    std::size_t enemies;
+    std::size_t player_bullets;
+    std::size_t enemy_bullets;
+    std::size_t boss_bullets;
+    std::size_t explosions;
+};
+
+// largest number of each kind of entity that can be alive at once in a session with the given settings
+EntityCounts pool_capacity(const GameParams& params);
+
+
+
+/** @enum GameKernel
+ * @brief Parts of a tick that GameState::run_kernel() can run on their own, e.g. to benchmark them
+ */
+enum GameKernel
+{
+    kernel_move_enemies,
+    kernel_move_bullets,
+    kernel_move_boss_bullet,
+    kernel_remove_enemy,
+    kernel_player_hit,
+    kernel_player_hit_boss,
+    kernel_boss_hit,
+    kernel_draw_explosion
+};
+
+
+
+/** @enum GameOutcome
+ * @brief Result of a session. A session is Playing until the game over or win signal would have been emitted.
+ */
+enum class GameOutcome { Playing, Lost, Won };
+
+
+
+/** @class GameState
+ * @brief The simulation of one session of Space Invaders
+ *
+ * All positions, timers and rules of the game live here. The state only changes through step(), which consumes
+ * simulation time in fixed ticks of tick_ms milliseconds.
+ */
+class GameState
+{
+public:
+    // length of one fixed simulation step in milliseconds. Every interval used by the game is a multiple of this.
+    static const int tick_ms = 5;
+
+    // number of frames of an explosion animation. Frame 0 is drawn when an explosion starts and frame explosion_frames - 1 last.
+    static const int explosion_frames = 14;
+
+    explicit GameState(const GameParams& params, std::uint64_t new_seed = random_seed());
+    void reset(const GameParams& params, std::uint64_t new_seed = random_seed());
+
+    int step(int dt, const GameInput& input);
+    int step(int dt, InputSource& input);
+    void tick(const GameInput& input);
+
+    // read access for painting and for headless drivers
+    const Formation& get_enemies() const { return enemies; }
+    const BulletArray& get_enemy_bullets() const { return enemy_bullets; }
+    const BulletArray& get_player_bullets() const { return player_bullets; }
+    const BulletArray& get_boss_bullets() const { return boss_bullets; }
+    const std::vector<std::pair<std::pair<int,int>, int>>& get_explosion_locations() const { return explosion_locations; }
+    const std::pair<std::pair<int,int>, int>& get_boss_explosion_location() const { return boss_explosion_location; }
+    std::pair<int,int> get_player_position() const { return player_position; }
+    std::pair<int,int> get_boss_position() const { return boss_position; }
+    bool is_alive() const { return alive; }
+    int get_lives_count() const { return lives_count; }
+    int get_boss_health() const { return boss_health; }
+    int get_total_boss_health() const { return total_boss_health; }
+    bool is_boss_message() const { return boss_message; }
+    bool is_boss_battle() const { return start_boss_battle; }
+    bool is_boss_alive() const { return boss_alive; }
+    bool is_win_message() const { return win_message; }
+    GameOutcome get_outcome() const { return outcome; }
+    long long get_ticks() const { return ticks; }
+    const EntityCounts& get_peak_counts() const { return peak_counts; }
+    const EntityCounts& get_capacity() const { return capacity; }
+    const EntityCounts& get_overflows() const { return overflows; }
+    const GameParams& get_params() const { return params; }
+    std::uint64_t get_seed() const { return seed; }
+    std::uint64_t checksum() const;
+
+    // writes the whole state to a snapshot, and restores it from one that may be read in place from a mapped file. See snapshot.h.
+    void save_snapshot(std::vector<unsigned char>& out) const;
+    bool restore_snapshot(const unsigned char* data, std::size_t size, std::string& error);
+
+    // records the controls of every tick into a replay, or stops recording if nullptr. The replay has to outlive the recording.
+    void set_recorder(Replay* new_recorder) { recorder = new_recorder; }
+
+    // places entities and runs single parts of a tick without playing up to that point, for benchmarks and stress tests
+    void clear_entities();
+    void spawn_formation(int columns, int rows, int left, int top, int pitch_x, int pitch_y, std::size_t count);
+    void spawn_bullet(int x, int y, BulletKind kind);
+    void spawn_explosion(int x, int y, int frame);
+    void run_kernel(GameKernel kernel);
+
+    // phases of a tick, in the order tick() runs them
+    void advance_timers();
+    void integrate(const GameInput& input);
+    void collide();
+    void resolve();
+    void spawn(const GameInput& input);
+
+private:
+    void move_player(const GameInput& input);
+    void fire_player_bullet();
+    void move_enemies();
+    void move_bullets();
+    void remove_enemy();
+    void enemy_fire_bullet();
+    void player_hit();
+    void respawn();
+    void boss_battle_message();
+    void move_boss();
+    void move_boss_bullet();
+    void boss_fire_bullet();
+    void player_hit_boss();
+    void boss_hit();
+    void win_message_appear();
+    void draw_explosion();
+    void draw_boss_explosion();
+    void kill_player();
+    void check_progress();
+    void update_peak_counts();
+    void reserve_pools();
+
+    // settings of the session, and the seed of the random number generator that decides which enemies fire. A session is fully determined by these and the controls of each tick.
+    GameParams params;
+    std::uint64_t seed;
+    RandomGenerator generator;
+
+    // replay that the controls of every tick are recorded into, if any
+    Replay* recorder;
+
+    // simulation time that has not been consumed by a tick yet
+    int accumulator;
+    long long ticks;
+    GameOutcome outcome;
+
+    // highest number of live entities seen in each container during the session
+    EntityCounts peak_counts;
+
+    // size of each container, reserved when the session starts, so ticks do not allocate while the rules stay within it
+    EntityCounts capacity;
+
+    // number of entities of each kind spawned past the capacity of their container since the session started or was restored.
+    // They are still spawned, so the game plays the same, but the tick may allocate; anything but 0 means pool_capacity() is wrong.
+    EntityCounts overflows;
+
+    // true if bullets moved during the current tick, which is when collisions are checked
+    bool bullet_step;
+
+    // results of the collide phase that the resolve phase applies. Every entity that collided is marked, so that all of them can be removed in one pass.
+    // Enemies that were hit are listed by their cell, column * rows + row, since only a few can be hit in one tick.
+    std::vector<int> dead_enemies;
+    std::vector<unsigned char> dead_player_bullets;
+    std::vector<unsigned char> dead_enemy_bullets;
+    std::vector<unsigned char> dead_boss_bullets;
+    bool enemies_hit;
+    bool player_was_hit;
+    int boss_hits;
+
+    // which bullets of a group are inside the box of the player or the boss, written by mark_points_in_box() with one bit per bullet
+    std::vector<std::uint64_t> hit_masks;
+
+    // vectors that store explosion locations
+    std::vector<std::pair<std::pair<int,int>, int>> explosion_locations;
+    std::pair<std::pair<int,int>, int> boss_explosion_location;
+
+    // timers related to explosions
+    SimTimer explosion_timer;
+    SimTimer boss_explosion_timer;
+
+    // timers related to displaying messages
+    SimTimer boss_battle_timer;
+    SimTimer game_over_timer;
+    SimTimer win_message_timer;
+
+
+    // ************** PLAYER VARIABLES ****************//
+
+    // timers related to player movement/respawn/fire-rate
+    SimTimer move_timer;
+    SimTimer shoot_timer;
+    SimTimer respawn_timer;
+
+    // player location and bullets
+    BulletArray player_bullets;
+    std::pair<int,int> player_position;
+
+
+    // other variables related to player
+    bool alive;
+    bool moving_right;
+    int lives_count;
+
+
+    // ************** ENEMY VARIABLES *****************//
+
+    // timers related to enemy movement/fire-rate
+    SimTimer enemy_timer;
+    SimTimer bullet_timer;
+    SimTimer enemy_fire_bullet_timer;
+
+    // enemies and their bullets
+    BulletArray enemy_bullets;
+    Formation enemies;
+
+
+    // ************** BOSS VARIABLES ****************//
+
+    // timers related to boss movement/fire-rate
+    SimTimer boss_move_timer;
+    SimTimer boss_fire_rate_timer;
+
+    // boss position and bullets
+    std::pair<int,int> boss_position;
+    BulletArray boss_bullets;
+
+    // other variables related to boss
+    bool boss_message;
+    bool start_boss_battle;
+    bool boss_moving_right;
+    int boss_health;
+    int total_boss_health;
+    bool win_message;
+    bool boss_alive;
+};
+
+
+
+#endif // GAMESTATE_H
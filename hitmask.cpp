@@ -0,0 +1,151 @@
+/** @file hitmask.cpp
+ * @brief Contains implementation of the collision kernel. The kernel has a scalar, an SSE2 and an AVX2 version, chosen on first use.
+ *
+ * Every version writes the same mask. Bit i % 64 of word i / 64 is set if point i is inside the box, and the bits past
+ * the last point are 0. The overlap tests of the game are symmetric, so testing one bullet against many boxes of equal
+ * size is the same as testing the positions of the boxes against one box of that size around the bullet. The SIMD
+ * versions are compiled with target attributes, so the rest of the program does not need to be built for those
+ * instruction sets.
+ */
+
+#include "hitmask.h"
+
+#ifdef SIMDPATH_X86
+#include <immintrin.h>
+#endif
+
+
+// writes the hit mask of count points and returns true if any point is inside the box
+typedef bool (*MarkPoints)(const int* x, const int* y, std::size_t count, const HitBox& box, std::uint64_t* masks);
+
+
+/** Returns the bits of the points from first to last - 1 that are inside the box, shifted so that point first is bit 0.
+ */
+static inline std::uint64_t mark_range_scalar(const int* x, const int* y, std::size_t first, std::size_t last, const HitBox& box) {
+    std::uint64_t bits = 0;
+    for (std::size_t i = first; i < last; ++i) {
+        const bool inside = (x[i] > box.left) & (x[i] < box.right) & (y[i] > box.top) & (y[i] < box.bottom);
+        bits |= std::uint64_t(inside) << (i - first);
+    }
+    return bits;
+}
+
+
+/** Scalar kernel. Tests one point at a time without branches.
+ */
+static bool mark_points_scalar(const int* x, const int* y, std::size_t count, const HitBox& box, std::uint64_t* masks) {
+    std::uint64_t any = 0;
+    for (std::size_t first = 0; first < count; first += 64) {
+        const std::size_t last = count - first < 64 ? count : first + 64;
+        masks[first / 64] = mark_range_scalar(x, y, first, last, box);
+        any |= masks[first / 64];
+    }
+    return any != 0;
+}
+
+
+#ifdef SIMDPATH_X86
+
+/** SSE2 kernel. Tests 4 points per compare, 16 per step, and the last points of the mask one at a time.
+ */
+__attribute__((target("sse2")))
+static bool mark_points_sse2(const int* x, const int* y, std::size_t count, const HitBox& box, std::uint64_t* masks) {
+    const __m128i left = _mm_set1_epi32(box.left);
+    const __m128i top = _mm_set1_epi32(box.top);
+    const __m128i right = _mm_set1_epi32(box.right);
+    const __m128i bottom = _mm_set1_epi32(box.bottom);
+
+    std::uint64_t any = 0;
+    for (std::size_t first = 0; first < count; first += 64) {
+        const std::size_t last = count - first < 64 ? count : first + 64;
+        std::uint64_t bits = 0;
+        std::size_t i = first;
+        for (; i + 16 <= last; i += 16) {
+            for (int group = 0; group < 16; group += 4) {
+                const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i + group));
+                const __m128i py = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i + group));
+                const __m128i inside_x = _mm_and_si128(_mm_cmpgt_epi32(px, left), _mm_cmplt_epi32(px, right));
+                const __m128i inside_y = _mm_and_si128(_mm_cmpgt_epi32(py, top), _mm_cmplt_epi32(py, bottom));
+                const unsigned lanes = _mm_movemask_ps(_mm_castsi128_ps(_mm_and_si128(inside_x, inside_y)));
+                bits |= std::uint64_t(lanes) << (i + group - first);
+            }
+        }
+        if (i < last)
+            bits |= mark_range_scalar(x, y, i, last, box) << (i - first);
+        masks[first / 64] = bits;
+        any |= bits;
+    }
+    return any != 0;
+}
+
+
+/** AVX2 kernel. Tests 8 points per compare, 16 per step, and the last points of the mask one at a time.
+ */
+__attribute__((target("avx2")))
+static bool mark_points_avx2(const int* x, const int* y, std::size_t count, const HitBox& box, std::uint64_t* masks) {
+    const __m256i left = _mm256_set1_epi32(box.left);
+    const __m256i top = _mm256_set1_epi32(box.top);
+    const __m256i right = _mm256_set1_epi32(box.right);
+    const __m256i bottom = _mm256_set1_epi32(box.bottom);
+
+    std::uint64_t any = 0;
+    for (std::size_t first = 0; first < count; first += 64) {
+        const std::size_t last = count - first < 64 ? count : first + 64;
+        std::uint64_t bits = 0;
+        std::size_t i = first;
+        for (; i + 16 <= last; i += 16) {
+            for (int group = 0; group < 16; group += 8) {
+                const __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i + group));
+                const __m256i py = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i + group));
+                const __m256i inside_x = _mm256_and_si256(_mm256_cmpgt_epi32(px, left), _mm256_cmpgt_epi32(right, px));
+                const __m256i inside_y = _mm256_and_si256(_mm256_cmpgt_epi32(py, top), _mm256_cmpgt_epi32(bottom, py));
+                const unsigned lanes = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_and_si256(inside_x, inside_y)));
+                bits |= std::uint64_t(lanes) << (i + group - first);
+            }
+        }
+        if (i < last)
+            bits |= mark_range_scalar(x, y, i, last, box) << (i - first);
+        masks[first / 64] = bits;
+        any |= bits;
+    }
+    return any != 0;
+}
+
+#endif
+
+
+#ifdef SIMDPATH_X86
+// kernel used by mark_points_in_box(). The fastest one the CPU supports is chosen on first use.
+static KernelDispatch<MarkPoints> mark_points(mark_points_scalar, mark_points_sse2, mark_points_avx2);
+#else
+static KernelDispatch<MarkPoints> mark_points(mark_points_scalar, mark_points_scalar, mark_points_scalar);
+#endif
+
+
+/** Tests count points against a box and writes which of them are inside as a hit mask.
+ * @param x are the x coordinates of the points
+ * @param y are the y coordinates of the points
+ * @param count is the number of points
+ * @param box is the box. Points on its edges are outside.
+ * @param masks receives the mask. It has to hold hit_mask_words(count) words.
+ * @return true if any point is inside the box
+ */
+bool mark_points_in_box(const int* x, const int* y, std::size_t count, const HitBox& box, std::uint64_t* masks) {
+    return mark_points.kernel()(x, y, count, box, masks);
+}
+
+
+/** Returns the kernel that mark_points_in_box() uses.
+ */
+SimdPath active_hit_path() {
+    return mark_points.path();
+}
+
+
+/** Chooses the kernel that mark_points_in_box() uses, e.g. to compare them. Paths the CPU does not support are refused.
+ * @param path is the kernel to use
+ * @return true if the kernel was chosen
+ */
+bool set_hit_path(SimdPath path) {
+    return mark_points.set_path(path);
+}
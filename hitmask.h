@@ -0,0 +1,62 @@
+/** @file hitmask.h
+ * @brief Contains the collision kernel, which tests many points against one box at a time with SSE2 or AVX2 where the CPU supports them.
+ */
+
+#ifndef HITMASK_H
+#define HITMASK_H
+
+#include <cstddef>
+#include <cstdint>
+#include "simdpath.h"
+
+
+
+/** @struct HitBox
+ * @brief Box that points are tested against. A point is inside if it is strictly between the edges, as in every overlap test of the game.
+ */
+struct HitBox
+{
+    int left;
+    int top;
+    int right;
+    int bottom;
+};
+
+
+
+// number of 64-bit words in the hit mask of count points
+inline std::size_t hit_mask_words(std::size_t count) { return (count + 63) / 64; }
+
+bool mark_points_in_box(const int* x, const int* y, std::size_t count, const HitBox& box, std::uint64_t* masks);
+
+template <class Visit>
+void for_each_hit(const std::uint64_t* masks, std::size_t count, Visit visit);
+
+SimdPath active_hit_path();
+bool set_hit_path(SimdPath path);
+
+
+
+/** Calls visit(i) with the index of every point whose bit is set in a hit mask, in order.
+ * @param masks is the hit mask written by mark_points_in_box()
+ * @param count is the number of points that were tested
+ */
+template <class Visit>
+void for_each_hit(const std::uint64_t* masks, std::size_t count, Visit visit) {
+    for (std::size_t word = 0, words = hit_mask_words(count); word < words; ++word) {
+        for (std::uint64_t bits = masks[word]; bits != 0; bits &= bits - 1) {
+#if defined(__GNUC__)
+            const int bit = __builtin_ctzll(bits);
+#else
+            int bit = 0;
+            while (((bits >> bit) & 1) == 0)
+                ++bit;
+#endif
+            visit(word * 64 + bit);
+        }
+    }
+}
+
+
+
+#endif // HITMASK_H
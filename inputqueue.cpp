@@ -0,0 +1,90 @@
+/** @file inputqueue.cpp
+ * @brief Contains implementation of InputQueue class. This class collects key presses between ticks and hands them to the simulation.
+ */
+
+#include "inputqueue.h"
+#include "profiler.h"
+
+
+/** Constructor for InputQueue. No key is held and no event is waiting.
+ */
+InputQueue::InputQueue() :
+    queue_start(0),
+    queue_size(0),
+    unpresented_size(0)
+{
+}
+
+
+/** Queues a press or release of a key for the next tick.
+ * @param key is the GameKey that changed
+ * @param pressed is true if the key was pressed and false if it was released
+ * @param time_ns is when the key changed, in nanoseconds
+ */
+void InputQueue::push(int key, bool pressed, std::int64_t time_ns) {
+
+    // the queue is only full if ticks stopped running, in which case the oldest event is applied without waiting for one
+    if (queue_size == capacity) {
+        apply(events[queue_start]);
+        queue_start = (queue_start + 1) % capacity;
+        --queue_size;
+    }
+
+    InputEvent& event = events[(queue_start + queue_size) % capacity];
+    event.time_ns = time_ns;
+    event.key = key;
+    event.pressed = pressed;
+    ++queue_size;
+}
+
+
+/** Applies one event to the held keys, and remembers a press so that a tap shorter than a tick is not lost.
+ */
+void InputQueue::apply(const InputEvent& event) {
+    held[event.key] = event.pressed;
+    if (event.pressed)
+        tapped[event.key] = true;
+}
+
+
+/** Applies every queued event in the order they arrived and returns the controls for the tick that is starting. Called at the start of each tick.
+ * @param input receives the controls: a direction is on if its key is held, and fire is on if its key is held or was pressed since the previous tick
+ */
+void InputQueue::consume(GameInput& input) {
+    ProfileScope scope("consume_input");
+
+    for (; queue_size > 0; --queue_size) {
+        const InputEvent& event = events[queue_start];
+        apply(event);
+        if (unpresented_size < capacity)
+            unpresented[unpresented_size++] = event.time_ns;
+        queue_start = (queue_start + 1) % capacity;
+    }
+
+    input.left = held[key_left];
+    input.right = held[key_right];
+    input.fire = held[key_fire] || tapped[key_fire];
+    tapped.reset();
+}
+
+
+/** Records the latency of every consumed event, now that a frame showing its effect has been presented.
+ * @param time_ns is when the frame was presented, on the same clock as the events
+ * @param latencies receives the time from each event to the frame in milliseconds
+ */
+void InputQueue::presented(std::int64_t time_ns, TimingStats& latencies) {
+    for (std::size_t i = 0; i < unpresented_size; ++i)
+        latencies.add((time_ns - unpresented[i]) / 1e6);
+    unpresented_size = 0;
+}
+
+
+/** Forgets every queued event and releases every key, e.g. when a new session starts.
+ */
+void InputQueue::clear() {
+    queue_start = 0;
+    queue_size = 0;
+    held.reset();
+    tapped.reset();
+    unpresented_size = 0;
+}
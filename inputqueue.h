@@ -0,0 +1,77 @@
+/** @file inputqueue.h
+ * @brief Contains declarations for the InputQueue class, which passes timestamped key presses to the simulation.
+ */
+
+#ifndef INPUTQUEUE_H
+#define INPUTQUEUE_H
+
+#include <bitset>
+#include <cstdint>
+#include <cstddef>
+#include "timingstats.h"
+#include "gamestate.h"
+
+
+
+/** @enum GameKey
+ * @brief Keys that control the game
+ */
+enum GameKey { key_left, key_right, key_fire, key_count };
+
+
+
+/** @struct InputEvent
+ * @brief One press or release of a key, and when it happened in nanoseconds on the clock of the caller
+ */
+struct InputEvent
+{
+    std::int64_t time_ns;
+    int key;
+    bool pressed;
+};
+
+
+
+/** @class InputQueue
+ * @brief Key presses and releases waiting for the next tick of the simulation, and which keys are held down
+ *
+ * Events are queued as they arrive and consumed together at the start of a tick, so that moving and firing react
+ * after the same delay. A key that was pressed and released again between two ticks still counts as pressed for one
+ * tick, so short taps of fire are not missed. The queue and the list of consumed events have a fixed size and never
+ * allocate. The times of consumed events are kept until the frame that shows them is presented, to measure latency.
+ */
+class InputQueue : public InputSource
+{
+public:
+    // largest number of events waiting for a tick. If more arrive, the oldest are applied to the held keys early.
+    static const std::size_t capacity = 64;
+
+    InputQueue();
+
+    void push(int key, bool pressed, std::int64_t time_ns);
+    void consume(GameInput& input) override;
+    void presented(std::int64_t time_ns, TimingStats& latencies);
+    void clear();
+
+    bool is_held(int key) const { return held[key]; }
+
+private:
+    void apply(const InputEvent& event);
+
+    // events that have not been consumed yet, oldest first from queue_start
+    InputEvent events[capacity];
+    std::size_t queue_start;
+    std::size_t queue_size;
+
+    // keys held down as of the last consumed event, and keys pressed since the last tick
+    std::bitset<key_count> held;
+    std::bitset<key_count> tapped;
+
+    // times of consumed events whose effect has not been presented yet
+    std::int64_t unpresented[capacity];
+    std::size_t unpresented_size;
+};
+
+
+
+#endif // INPUTQUEUE_H
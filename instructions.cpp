@@ -4,9 +4,10 @@
 
 #include "instructions.h"
 #include "ui_instructions.h"
+#include "assetregistry.h"
 #include <QPainter>
 
-/** Constructor for Instructions class. Loads all images and initializes timers and variables necessary to animate images of player and enemies
+/** Constructor for Instructions class. Initializes timers and variables necessary to animate images of player and enemies
  * @param parent is the parent widget
  */
 Instructions::Instructions(QWidget *parent) :
@@ -15,20 +16,6 @@ Instructions::Instructions(QWidget *parent) :
 {
     ui->setupUi(this);
 
-    // loads all instruction text
-    instructions1 = QPixmap(":/image/IMAGES/instructions1.png");
-    instructions2 = QPixmap(":/image/IMAGES/instructions2.png");
-    instructions3 = QPixmap(":/image/IMAGES/instructions3.png");
-    instructions3_5 = QPixmap(":/image/IMAGES/instructions3.5.png");
-    instructions4 = QPixmap(":/image/IMAGES/instructions4.png");
-
-    // loads images
-    player = QPixmap(":/image/IMAGES/spaceship.png");
-    enemy = QPixmap(":/image/IMAGES/invader.png");
-    player_bullet = QPixmap(":/image/IMAGES/player_bullet.png");
-    enemy_bullet = QPixmap(":/image/IMAGES/enemy_bullet.png");
-    boss = QPixmap(":/image/IMAGES/boss.png");
-
     // sets up positions of images of player and enemies
     moving_right = true;
     boss_moving_right = true;
@@ -57,22 +44,23 @@ Instructions::~Instructions()
 }
 
 
-/** This function is responsible for displaying all labels and images on the screen.
+/** This function is responsible for displaying all labels and images on the screen. The images come from the AssetRegistry already scaled to the size they are drawn at.
  */
 void Instructions::paintEvent(QPaintEvent *)
 {
+    const qreal dpr = devicePixelRatioF();
     QPainter p(this);
-    p.drawPixmap(15,15,instructions1);
-    p.drawPixmap(176,126,instructions2);
-    p.drawPixmap(56,220,instructions3);
-    p.drawPixmap(99,245,instructions3_5);
-    p.drawPixmap(15,350,instructions4);
-    p.drawPixmap(player_position.first, player_position.second, 50, 50, player);
-    p.drawPixmap(player_bullet_position.first, player_bullet_position.second, 11, 15, player_bullet);
-    p.drawPixmap(548, 130, 50, 50, player);
-    p.drawPixmap(enemy_bullet_position.first, enemy_bullet_position.second, 11, 15, enemy_bullet);
-    p.drawPixmap(540, 200, 65, 40, enemy);
-    p.drawPixmap(boss_position.first, boss_position.second, 125, 66, boss);
+    p.drawPixmap(15,15,AssetRegistry::instance().scaled(":/image/IMAGES/instructions1.png", QSize(), dpr));
+    p.drawPixmap(176,126,AssetRegistry::instance().scaled(":/image/IMAGES/instructions2.png", QSize(), dpr));
+    p.drawPixmap(56,220,AssetRegistry::instance().scaled(":/image/IMAGES/instructions3.png", QSize(), dpr));
+    p.drawPixmap(99,245,AssetRegistry::instance().scaled(":/image/IMAGES/instructions3.5.png", QSize(), dpr));
+    p.drawPixmap(15,350,AssetRegistry::instance().scaled(":/image/IMAGES/instructions4.png", QSize(), dpr));
+    p.drawPixmap(player_position.first, player_position.second, AssetRegistry::instance().scaled(":/image/IMAGES/spaceship.png", QSize(50,50), dpr));
+    p.drawPixmap(player_bullet_position.first, player_bullet_position.second, AssetRegistry::instance().scaled(":/image/IMAGES/player_bullet.png", QSize(11,15), dpr));
+    p.drawPixmap(548, 130, AssetRegistry::instance().scaled(":/image/IMAGES/spaceship.png", QSize(50,50), dpr));
+    p.drawPixmap(enemy_bullet_position.first, enemy_bullet_position.second, AssetRegistry::instance().scaled(":/image/IMAGES/enemy_bullet.png", QSize(11,15), dpr));
+    p.drawPixmap(540, 200, AssetRegistry::instance().scaled(":/image/IMAGES/invader.png", QSize(65,40), dpr));
+    p.drawPixmap(boss_position.first, boss_position.second, AssetRegistry::instance().scaled(":/image/IMAGES/boss.png", QSize(125,66), dpr));
 }
 
 
@@ -119,8 +107,7 @@ void Instructions::move_player() {
         boss_moving_right = true;
     }
 
-    QCoreApplication::processEvents();
-    repaint();
+    update();
 }
 
 
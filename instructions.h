@@ -55,17 +55,6 @@ private:
 
     bool moving_right;
     bool boss_moving_right;
-
-    QPixmap instructions1;
-    QPixmap instructions2;
-    QPixmap instructions3;
-    QPixmap instructions3_5;
-    QPixmap instructions4;
-    QPixmap player;
-    QPixmap player_bullet;
-    QPixmap enemy;
-    QPixmap enemy_bullet;
-    QPixmap boss;
 };
 
 
@@ -11,11 +11,14 @@
  */
 
 /** @file main.cpp
- * @brief standard Qt main
+ * @brief standard Qt main. Passing --stress starts a game of the stress preset right away instead of showing the menu, and
+ * --replay FILE plays back a recorded session, e.g. the space_invaders_last_session.sirp saved after every game.
+ * --resume FILE continues a session from a snapshot, e.g. the space_invaders_quicksave.siss saved with F5.
  */
 
 #include "mainwindow.h"
 #include <QApplication>
+#include <QDir>
 
 int main(int argc, char *argv[])
 {
@@ -24,5 +27,23 @@ int main(int argc, char *argv[])
     w.setWindowTitle("Space Invaders");
     w.show();
 
+    const QStringList arguments = a.arguments();
+    const int replay_index = arguments.indexOf("--replay");
+    const int resume_index = arguments.indexOf("--resume");
+    if (replay_index >= 0 && replay_index + 1 < arguments.size()) {
+        Replay replay;
+        std::string error;
+        if (replay.load(QDir::toNativeSeparators(arguments[replay_index + 1]).toStdString(), error))
+            w.replay_game_begin(replay);
+        else
+            qWarning("%s", error.c_str());
+    }
+    else if (resume_index >= 0 && resume_index + 1 < arguments.size()) {
+        w.resume_game_begin(arguments[resume_index + 1]);
+    }
+    else if (arguments.contains("--stress")) {
+        w.stress_game_begin();
+    }
+
     return a.exec();
 }
@@ -7,6 +7,7 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "gameboard.h"
+#include "assetregistry.h"
 #include <QPushButton>
 #include <QVBoxLayout>
 #include <QLabel>
@@ -17,18 +18,14 @@
  */
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
-    ui(new Ui::MainWindow)
+    ui(new Ui::MainWindow),
+    board(nullptr),
+    difficulty(1)
 {
     ui->setupUi(this);
 
     this->setFixedSize(700,500);
 
-    // loads title images
-    welcome_message = QPixmap(":/image/IMAGES/welcome.png");
-    select_difficulty = QPixmap(":/image/IMAGES/select_difficulty.png");
-    win = QPixmap(":/image/IMAGES/congratulations.png");
-    game_over_message = QPixmap(":/image/IMAGES/game_over.png");
-
     // displays main menu
     this->menu_screen();
 
@@ -43,6 +40,44 @@ MainWindow::~MainWindow()
 }
 
 
+/** Removes the current screen from the window. The gameboard is kept for the next game. Any other screen is deleted once control returns to the event loop, because the button that was pressed to leave it may belong to it.
+ */
+void MainWindow::clear_screen() {
+    QWidget* wid = this->takeCentralWidget();
+    if (wid == nullptr)
+        return;
+
+    // the window keeps ownership of the board while it is not displayed
+    if (wid == board)
+        board->setParent(this);
+    else
+        wid->deleteLater();
+}
+
+
+/** Starts a game with the settings of one of the presets. The first game creates the gameboard; later games reset it.
+ * @param new_difficulty is 1 for easy, 2 for medium, 3 for hard, 4 for impossible and 5 for stress
+ */
+void MainWindow::start_game(int new_difficulty) {
+    difficulty = new_difficulty;
+
+    if (board == nullptr) {
+        board = new Gameboard(this,preset_params(difficulty));
+
+        // display game over or win screen when the corresponding signal is emitted
+        QObject::connect(board,SIGNAL(game_over()),this,SLOT(game_over_screen()));
+        QObject::connect(board,SIGNAL(win_game()),this,SLOT(win_screen()));
+    }
+    else {
+        board->reset(preset_params(difficulty));
+    }
+
+    // the board was hidden when it was last removed from the window
+    this->setCentralWidget(board);
+    board->show();
+}
+
+
 /** Displays the main menu screen
  */
 void MainWindow::menu_screen() {
@@ -50,7 +85,7 @@ void MainWindow::menu_screen() {
 
     // sets title of menu screen
     QLabel* welcome = new QLabel;
-    welcome->setPixmap(welcome_message);
+    welcome->setPixmap(AssetRegistry::instance().image(":/image/IMAGES/welcome.png"));
     welcome->setAlignment(Qt::AlignCenter);
 
     // creates "start game" button that goes to level select screen when pressed
@@ -88,14 +123,13 @@ void MainWindow::menu_screen() {
 void MainWindow::select_level() {
 
     // clears current screen
-    QWidget* wid = this->centralWidget();
-    wid->setParent(nullptr);
+    this->clear_screen();
 
     QWidget* central = new QWidget;
 
     // sets title of screen
     QLabel* difficulty = new QLabel();
-    difficulty->setPixmap(select_difficulty);
+    difficulty->setPixmap(AssetRegistry::instance().image(":/image/IMAGES/select_difficulty.png"));
     difficulty->setAlignment(Qt::AlignCenter);
 
     // creates "easy" button that starts easy game when pressed
@@ -118,6 +152,11 @@ void MainWindow::select_level() {
     impossible_button->setText("Impossible");
     QObject::connect(impossible_button,SIGNAL(clicked(bool)),this,SLOT(impossible_game_begin()));
 
+    // creates "stress" button that starts a game with thousands of enemies and hundreds of bullets per second when pressed
+    QPushButton* stress_button = new QPushButton;
+    stress_button->setText("Stress");
+    QObject::connect(stress_button,SIGNAL(clicked(bool)),this,SLOT(stress_game_begin()));
+
     // creates "back" button that goes back to menu screen when pressed
     QPushButton* go_back = new QPushButton;
     go_back->setText("Back");
@@ -130,6 +169,7 @@ void MainWindow::select_level() {
     buttons->addWidget(medium_button);
     buttons->addWidget(hard_button);
     buttons->addWidget(impossible_button);
+    buttons->addWidget(stress_button);
     buttons->addWidget(go_back);
 
     // add layout to central widget
@@ -145,8 +185,7 @@ void MainWindow::select_level() {
 void MainWindow::select_instructions() {
 
     // clears current screen
-    QWidget* wid = this->centralWidget();
-    wid->setParent(nullptr);
+    this->clear_screen();
 
     QWidget* central = new QWidget;
 
@@ -176,8 +215,7 @@ void MainWindow::select_instructions() {
 void MainWindow::return_to_menu() {
 
     // clears current screen
-    QWidget* wid = this->centralWidget();
-    wid->setParent(nullptr);
+    this->clear_screen();
 
     // displays menu screen
     this->menu_screen();
@@ -189,14 +227,13 @@ void MainWindow::return_to_menu() {
 void MainWindow::win_screen() {
 
     // clears current screen
-    QWidget* wid = this->centralWidget();
-    wid->setParent(nullptr);
+    this->clear_screen();
 
     QWidget* central = new QWidget;
 
     // create win message
     QLabel* win_message = new QLabel;
-    win_message->setPixmap(win);
+    win_message->setPixmap(AssetRegistry::instance().image(":/image/IMAGES/congratulations.png"));
     win_message->setAlignment(Qt::AlignCenter);
 
     // create "play again" button that returns to level select screen when pressed
@@ -227,15 +264,19 @@ void MainWindow::win_screen() {
  */
 void MainWindow::game_over_screen() {
 
+    // retries the preset of the session that ended, which differs from the one started if F9 restored a quicksave of another preset
+    const int played = preset_of(board->get_state().get_params());
+    if (played > 0)
+        difficulty = played;
+
     // clears current screen
-    QWidget* wid = this->centralWidget();
-    wid->setParent(nullptr);
+    this->clear_screen();
 
     QWidget* central = new QWidget;
 
     // creates game over message
     QLabel* game_over = new QLabel;
-    game_over->setPixmap(game_over_message);
+    game_over->setPixmap(AssetRegistry::instance().image(":/image/IMAGES/game_over.png"));
     game_over->setAlignment(Qt::AlignCenter);
 
     // creates "retry" button that restarts game depending on which difficulty the player was initially on
@@ -258,6 +299,10 @@ void MainWindow::game_over_screen() {
         QObject::connect(retry_button,SIGNAL(clicked(bool)),this,SLOT(impossible_game_begin()));
     }
 
+    if (difficulty == stress_difficulty) {
+        QObject::connect(retry_button,SIGNAL(clicked(bool)),this,SLOT(stress_game_begin()));
+    }
+
     // creates "return to menu" button that returns to menu screen when pressed
     QPushButton* return_to_menu_button = new QPushButton;
     return_to_menu_button->setText("Return to menu");
@@ -283,13 +328,10 @@ void MainWindow::game_over_screen() {
 void MainWindow::easy_game_begin() {
 
     // clears current screen
-    QWidget* wid = this->centralWidget();
-    wid->setParent(nullptr);
+    this->clear_screen();
 
-    // creates gameboard with corresponding "easy" settings. In the order they are initialized, they are: enemy speed, enemy fire rate, boss speed, boss fire rate, and boss health.
-    board = new Gameboard(this,600,600,30,1000,20);
-    this->setCentralWidget(board);
-    difficulty = 1;
+    // starts a game with corresponding "easy" settings
+    this->start_game(1);
 }
 
 
@@ -298,13 +340,10 @@ void MainWindow::easy_game_begin() {
 void MainWindow::medium_game_begin() {
 
     // clears current screen
-    QWidget* wid = this->centralWidget();
-    wid->setParent(nullptr);
+    this->clear_screen();
 
-    // creates gameboard with corresponding "medium" settings. In the order they are initialized, they are: enemy speed, enemy fire rate, boss speed, boss fire rate, and boss health.
-    board = new Gameboard(this,550,400,30,750,25);
-    this->setCentralWidget(board);
-    difficulty = 2;
+    // starts a game with corresponding "medium" settings
+    this->start_game(2);
 }
 
 
@@ -313,13 +352,10 @@ void MainWindow::medium_game_begin() {
 void MainWindow::hard_game_begin() {
 
     // clears current screen
-    QWidget* wid = this->centralWidget();
-    wid->setParent(nullptr);
+    this->clear_screen();
 
-    // creates gameboard with corresponding "hard" settings. In the order they are initialized, they are: enemy speed, enemy fire rate, boss speed, boss fire rate, and boss health.
-    board = new Gameboard(this,500,200,20,400,30);
-    this->setCentralWidget(board);
-    difficulty = 3;
+    // starts a game with corresponding "hard" settings
+    this->start_game(3);
 }
 
 
@@ -328,12 +364,57 @@ void MainWindow::hard_game_begin() {
 void MainWindow::impossible_game_begin() {
 
     // clears current screen
-    QWidget* wid = this->centralWidget();
-    wid->setParent(nullptr);
+    this->clear_screen();
 
-    // creates gameboard with corresponding "impossible" settings. In the order they are initialized, they are: enemy speed, enemy fire rate, boss speed, boss fire rate, and boss health.
-    board = new Gameboard(this,450,100,10,300,40);
-    this->setCentralWidget(board);
-    difficulty = 4;
+    // starts a game with corresponding "impossible" settings
+    this->start_game(4);
+}
+
+
+/** Starts a stress game
+ */
+void MainWindow::stress_game_begin() {
+
+    // clears current screen
+    this->clear_screen();
+
+    // starts a game with the "stress" settings
+    this->start_game(stress_difficulty);
+}
+
+
+/** Plays a recorded session back on the gameboard. Retrying afterwards starts a new game of the recording's preset.
+ * @param replay is the recorded session
+ */
+void MainWindow::replay_game_begin(const Replay& replay) {
+
+    // clears current screen
+    this->clear_screen();
+
+    // shows the board, then replaces the session it started with the recording
+    this->start_game(difficulty);
+    board->start_replay(replay);
 }
 
+
+/** Continues a session from a snapshot file, or returns to the menu if the file cannot be restored.
+ * @param path is the snapshot file
+ * @return true if the session was restored
+ */
+bool MainWindow::resume_game_begin(const QString& path) {
+
+    // clears current screen
+    this->clear_screen();
+
+    // shows the board, then replaces the session it started with the snapshot. Retrying plays the preset of the snapshot.
+    this->start_game(difficulty);
+    if (board->restore_snapshot(path)) {
+        const int restored = preset_of(board->get_state().get_params());
+        if (restored > 0)
+            difficulty = restored;
+        return true;
+    }
+
+    this->return_to_menu();
+    return false;
+}
@@ -34,6 +34,8 @@ class MainWindow : public QMainWindow
 public:
     explicit MainWindow(QWidget *parent = 0);
     ~MainWindow();
+    void replay_game_begin(const Replay& replay);
+    bool resume_game_begin(const QString& path);
 
 public slots:
     void select_level();
@@ -44,21 +46,22 @@ public slots:
     void medium_game_begin();
     void hard_game_begin();
     void impossible_game_begin();
+    void stress_game_begin();
     void game_over_screen();
     void win_screen();
 
 
 private:
+    void clear_screen();
+    void start_game(int new_difficulty);
+
     Ui::MainWindow *ui;
+
+    // the gameboard is created for the first game and reused by every game after it
     Gameboard* board;
     Instructions* instructions;
     int difficulty;
 
-    QPixmap welcome_message;
-    QPixmap select_difficulty;
-    QPixmap win;
-    QPixmap game_over_message;
-
 
 };
 
@@ -0,0 +1,152 @@
+/** @file profiler.cpp
+ * @brief Contains implementation of Profiler class. This class keeps the most recent timed scopes of every thread and exports them.
+ */
+
+#include "profiler.h"
+#include <algorithm>
+
+
+/** Returns a small number that identifies the calling thread in traces. Threads are numbered in the order they first record an event.
+ */
+static unsigned thread_number() {
+    static std::atomic<unsigned> threads_seen(0);
+    static thread_local unsigned number = ++threads_seen;
+    return number;
+}
+
+
+/** Constructor for Profiler. Recording starts disabled, so that scoped timers cost nothing until a profile is asked for, and
+ * the buffer is allocated up front, so recording never allocates.
+ */
+Profiler::Profiler() :
+    enabled(false),
+    origin(std::chrono::steady_clock::now()),
+    write_position(0),
+    slots(capacity)
+{
+    for (Slot& slot : slots) {
+        slot.sequence.store(0, std::memory_order_relaxed);
+        slot.name.store(nullptr, std::memory_order_relaxed);
+        slot.start_ns.store(0, std::memory_order_relaxed);
+        slot.duration_ns.store(0, std::memory_order_relaxed);
+        slot.thread.store(0, std::memory_order_relaxed);
+    }
+}
+
+
+/** Returns the profiler of the app, creating it on first use.
+ */
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+
+/** Returns the current time in nanoseconds since the profiler was created.
+ */
+std::uint64_t Profiler::now_ns() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+
+/** Records one event, overwriting the oldest one if the buffer is full. Safe to call from any thread.
+ * @param name is the name of the event. Only the pointer is stored.
+ * @param start_ns is when the event started, from now_ns()
+ * @param end_ns is when the event ended, from now_ns()
+ */
+void Profiler::record(const char* name, std::uint64_t start_ns, std::uint64_t end_ns) {
+    const std::uint64_t position = write_position.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots[position & (capacity - 1)];
+
+    // 0 marks the slot as being written, so readers skip it until the new sequence number is published
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start_ns.store(start_ns, std::memory_order_relaxed);
+    slot.duration_ns.store(end_ns - start_ns, std::memory_order_relaxed);
+    slot.thread.store(thread_number(), std::memory_order_relaxed);
+    slot.sequence.store(position + 1, std::memory_order_release);
+}
+
+
+/** Forgets every recorded event. Events that are being recorded while this runs may survive.
+ */
+void Profiler::clear() {
+    for (Slot& slot : slots)
+        slot.sequence.store(0, std::memory_order_relaxed);
+}
+
+
+/** Copies the events in the buffer, from the oldest to the newest. Slots that are written while they are copied are skipped.
+ * @param events receives the events. It is cleared first.
+ */
+void Profiler::snapshot(std::vector<ProfileEvent>& events) const {
+    events.clear();
+
+    const std::uint64_t end = write_position.load(std::memory_order_acquire);
+    const std::uint64_t begin = end > capacity ? end - capacity : 0;
+    for (std::uint64_t position = begin; position < end; ++position) {
+        const Slot& slot = slots[position & (capacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+            continue;
+
+        ProfileEvent event;
+        event.name = slot.name.load(std::memory_order_relaxed);
+        event.start_ns = slot.start_ns.load(std::memory_order_relaxed);
+        event.duration_ns = slot.duration_ns.load(std::memory_order_relaxed);
+        event.thread = slot.thread.load(std::memory_order_relaxed);
+
+        // keep the copy only if no writer started on the slot meanwhile
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == position + 1)
+            events.push_back(event);
+    }
+}
+
+
+/** Adds up the events of each name that started after the given time, e.g. the last second for the overlay. Names are ordered by total time, the largest first.
+ * @param since_ns is the earliest start of an event that is counted, from now_ns()
+ * @param summaries receives one summary per name. It is cleared first.
+ */
+void Profiler::summarize(std::uint64_t since_ns, std::vector<ProfileSummary>& summaries) const {
+    std::vector<ProfileEvent> events;
+    snapshot(events);
+
+    summaries.clear();
+    for (const ProfileEvent& event : events) {
+        if (event.start_ns < since_ns)
+            continue;
+
+        // names are string literals, so they are compared by pointer. There are only a handful of them.
+        std::vector<ProfileSummary>::iterator it = std::find_if(summaries.begin(), summaries.end(), [&](const ProfileSummary& s) { return s.name == event.name; });
+        if (it == summaries.end()) {
+            const ProfileSummary summary = { event.name, 0, 0, 0 };
+            it = summaries.insert(summaries.end(), summary);
+        }
+        const double ms = event.duration_ns / 1e6;
+        ++it->count;
+        it->total_ms += ms;
+        it->max_ms = std::max(it->max_ms, ms);
+    }
+
+    std::sort(summaries.begin(), summaries.end(), [](const ProfileSummary& a, const ProfileSummary& b) { return a.total_ms > b.total_ms; });
+}
+
+
+/** Writes the events in the buffer in the Chrome trace event format, as complete events with times in microseconds. The file can be opened in about:tracing or Perfetto.
+ * @param out is the stream the JSON is written to
+ */
+void Profiler::write_chrome_trace(std::ostream& out) const {
+    std::vector<ProfileEvent> events;
+    snapshot(events);
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); ++i) {
+        const ProfileEvent& event = events[i];
+        out << (i > 0 ? ",\n" : "\n")
+            << "{\"name\":\"" << event.name << "\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+            << ",\"ts\":" << event.start_ns / 1000 << '.' << (event.start_ns / 100) % 10
+            << ",\"dur\":" << event.duration_ns / 1000 << '.' << (event.duration_ns / 100) % 10 << '}';
+    }
+    out << "\n]}\n";
+}
@@ -0,0 +1,130 @@
+/** @file profiler.h
+ * @brief Contains declarations for the Profiler and ProfileScope classes, which record how long the phases of a frame take.
+ *
+ * Instrumented functions create a ProfileScope at their start. When it goes out of scope, it writes one event into the
+ * lock-free ring buffer of the Profiler. Events can be summarized for the in-game overlay or exported as a Chrome
+ * trace, which can be opened in about:tracing.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+
+
+/** @struct ProfileEvent
+ * @brief One measured scope: its name, when it started, how long it took and which thread ran it. Times are in nanoseconds since the profiler was created.
+ */
+struct ProfileEvent
+{
+    const char* name;
+    std::uint64_t start_ns;
+    std::uint64_t duration_ns;
+    unsigned thread;
+};
+
+
+
+/** @struct ProfileSummary
+ * @brief Time spent in all events of one name
+ */
+struct ProfileSummary
+{
+    const char* name;
+    long long count;
+    double total_ms;
+    double max_ms;
+};
+
+
+
+/** @class Profiler
+ * @brief Fixed-size ring buffer of ProfileEvents that any thread can write to without locking
+ *
+ * A writer claims a slot by incrementing the write position, fills it and then publishes it by storing its sequence
+ * number. Readers copy a slot and keep it only if its sequence number did not change meanwhile, so a slot that is being
+ * overwritten is skipped instead of read half written. Once the buffer is full, the oldest events are overwritten.
+ */
+class Profiler
+{
+public:
+    // number of events kept. A power of two, so positions wrap with a mask.
+    static const std::size_t capacity = 1 << 16;
+
+    Profiler();
+
+    static Profiler& instance();
+
+    void set_enabled(bool new_enabled) { enabled.store(new_enabled, std::memory_order_relaxed); }
+    bool is_enabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    std::uint64_t now_ns() const;
+    void record(const char* name, std::uint64_t start_ns, std::uint64_t end_ns);
+    void clear();
+
+    void snapshot(std::vector<ProfileEvent>& events) const;
+    void summarize(std::uint64_t since_ns, std::vector<ProfileSummary>& summaries) const;
+    void write_chrome_trace(std::ostream& out) const;
+
+private:
+    /** @struct Slot
+     * @brief Storage of one event. Every field is atomic, so a reader racing a writer is well defined and caught by the sequence number.
+     */
+    struct Slot
+    {
+        std::atomic<std::uint64_t> sequence;
+        std::atomic<const char*> name;
+        std::atomic<std::uint64_t> start_ns;
+        std::atomic<std::uint64_t> duration_ns;
+        std::atomic<unsigned> thread;
+    };
+
+    std::atomic<bool> enabled;
+
+    // time 0 of every event
+    std::chrono::steady_clock::time_point origin;
+
+    // number of events ever written. The next event goes to slot write_position % capacity.
+    std::atomic<std::uint64_t> write_position;
+    std::vector<Slot> slots;
+};
+
+
+
+/** @class ProfileScope
+ * @brief Measures the time from its creation to the end of its scope and records it in the Profiler of the app
+ *
+ * The name has to outlive the profiler, e.g. a string literal, because only the pointer is stored. While the profiler
+ * is disabled, a scope costs one relaxed load.
+ */
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* new_name) :
+        name(Profiler::instance().is_enabled() ? new_name : nullptr),
+        start_ns(name ? Profiler::instance().now_ns() : 0)
+    {
+    }
+
+    ~ProfileScope() {
+        if (name)
+            Profiler::instance().record(name, start_ns, Profiler::instance().now_ns());
+    }
+
+private:
+    ProfileScope(const ProfileScope&);
+    ProfileScope& operator=(const ProfileScope&);
+
+    const char* name;
+    std::uint64_t start_ns;
+};
+
+
+
+#endif // PROFILER_H
@@ -0,0 +1,28 @@
+/** @file randomgenerator.cpp
+ * @brief Contains implementation of RandomGenerator class. This class gives each session its own stream of random numbers.
+ */
+
+#include "randomgenerator.h"
+
+
+/** Constructor for RandomGenerator.
+ * @param seed is any number. Equal seeds give equal streams.
+ */
+RandomGenerator::RandomGenerator(std::uint64_t seed) {
+    this->seed(seed);
+}
+
+
+/** Restarts the generator from a seed. The four words of the state are filled with splitmix64, so that similar seeds,
+ * e.g. those of consecutive sessions, still give unrelated streams and the state is never all zeros.
+ * @param seed is any number
+ */
+void RandomGenerator::seed(std::uint64_t seed) {
+    for (std::uint64_t& word : state) {
+        seed += 0x9e3779b97f4a7c15ULL;
+        std::uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        word = z ^ (z >> 31);
+    }
+}
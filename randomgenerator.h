@@ -0,0 +1,67 @@
+/** @file randomgenerator.h
+ * @brief Contains declarations for the RandomGenerator class, the small and fast random number generator of a session.
+ */
+
+#ifndef RANDOMGENERATOR_H
+#define RANDOMGENERATOR_H
+
+#include <cstdint>
+
+
+
+/** @class RandomGenerator
+ * @brief xoshiro256** generator with bounded integer draws
+ *
+ * Every GameState owns one, so sessions on different threads share nothing and a session is reproduced from its seed
+ * alone. The state is four plain 64-bit words, which snapshots store as they are. below() draws an unbiased number in a
+ * range with one multiplication, and only divides in the rare case that the draw has to be rejected.
+ */
+class RandomGenerator
+{
+public:
+    explicit RandomGenerator(std::uint64_t seed = 0);
+    void seed(std::uint64_t seed);
+
+    std::uint64_t next();
+    std::uint32_t below(std::uint32_t bound);
+
+    // the whole state, for snapshots. A state of all zeros is never produced by seed() and must not be restored.
+    std::uint64_t state[4];
+};
+
+
+
+/** Returns the next 64 random bits.
+ */
+inline std::uint64_t RandomGenerator::next() {
+    const std::uint64_t result = ((state[1] * 5) << 7 | (state[1] * 5) >> 57) * 9;
+    const std::uint64_t t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = state[3] << 45 | state[3] >> 19;
+    return result;
+}
+
+
+/** Returns a random number from 0 to bound - 1, each equally likely, using Lemire's multiply and shift method.
+ * @param bound is the number of possible results. Must not be 0.
+ */
+inline std::uint32_t RandomGenerator::below(std::uint32_t bound) {
+    std::uint64_t product = (next() >> 32) * bound;
+    std::uint32_t low = static_cast<std::uint32_t>(product);
+    if (low < bound) {
+        const std::uint32_t threshold = static_cast<std::uint32_t>(-bound) % bound;
+        while (low < threshold) {
+            product = (next() >> 32) * bound;
+            low = static_cast<std::uint32_t>(product);
+        }
+    }
+    return static_cast<std::uint32_t>(product >> 32);
+}
+
+
+
+#endif // RANDOMGENERATOR_H
@@ -0,0 +1,293 @@
+/** @file replay.cpp
+ * @brief Contains implementation of Replay and ReplayPlayer classes. These record the controls of a session and play them back.
+ */
+
+#include "replay.h"
+#include <fstream>
+#include <iterator>
+
+// bits of the controls in ReplayChange::buttons
+static const unsigned char button_left = 1;
+static const unsigned char button_right = 2;
+static const unsigned char button_fire = 4;
+
+// first bytes of every replay file
+static const char replay_magic[4] = { 'S', 'I', 'R', 'P' };
+
+
+/** Appends an unsigned number in little endian order.
+ */
+static void put_uint(std::string& out, std::uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i, value >>= 8)
+        out.push_back(static_cast<char>(value & 0xff));
+}
+
+
+/** Appends an unsigned number as a variable length integer: 7 bits per byte, lowest first, with the top bit set on every byte but the last.
+ */
+static void put_varint(std::string& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+
+/** Reads numbers back from a buffer written with put_uint() and put_varint(). Reading past the end sets failed and returns 0.
+ */
+struct ReplayReader
+{
+    const std::string& data;
+    std::size_t position;
+    bool failed;
+
+    explicit ReplayReader(const std::string& new_data) : data(new_data), position(0), failed(false) {}
+
+    std::uint64_t uint(int bytes) {
+        if (data.size() - position < static_cast<std::size_t>(bytes)) {
+            failed = true;
+            return 0;
+        }
+        std::uint64_t value = 0;
+        for (int i = 0; i < bytes; ++i)
+            value |= std::uint64_t(static_cast<unsigned char>(data[position++])) << (8*i);
+        return value;
+    }
+
+    std::uint64_t varint() {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const std::uint64_t byte = uint(1);
+            value |= (byte & 0x7f) << shift;
+            if (failed || (byte & 0x80) == 0)
+                return value;
+        }
+        failed = true;
+        return 0;
+    }
+};
+
+
+/** Constructor for Replay. The replay is empty until a session is recorded into it or it is loaded.
+ */
+Replay::Replay() :
+    params(preset_params(1)),
+    seed(0),
+    ticks(0),
+    outcome(GameOutcome::Playing),
+    checksum(0)
+{
+}
+
+
+/** Starts recording a session that was just reset. Keeps the memory of the previous recording, and reserves reserved_changes changes the first time.
+ * @param state is the session, which has not run any tick yet
+ */
+void Replay::start(const GameState& state) {
+    params = state.get_params();
+    seed = state.get_seed();
+    changes.clear();
+    changes.reserve(reserved_changes);
+    ticks = 0;
+    outcome = GameOutcome::Playing;
+    checksum = 0;
+}
+
+
+/** Records the controls of the tick that is about to run. Only changes are stored.
+ * @param input are the controls of the tick
+ */
+void Replay::record(const GameInput& input) {
+    const unsigned char buttons = (input.left ? button_left : 0) | (input.right ? button_right : 0) | (input.fire ? button_fire : 0);
+    if (changes.empty() || changes.back().buttons != buttons) {
+        const ReplayChange change = { ticks, buttons };
+        changes.push_back(change);
+    }
+    ++ticks;
+}
+
+
+/** Stops recording and stores how the session ended, so that playing it back can be checked.
+ * @param state is the recorded session
+ */
+void Replay::finish(const GameState& state) {
+    ticks = state.get_ticks();
+    outcome = state.get_outcome();
+    checksum = state.checksum();
+}
+
+
+/** Writes the replay to a file.
+ * @param path is the path of the file, which is replaced if it exists
+ * @return true if the file was written
+ */
+bool Replay::save(const std::string& path) const {
+    std::string out(replay_magic, sizeof(replay_magic));
+    put_uint(out, version, 2);
+    put_uint(out, 0, 2);
+    put_uint(out, seed, 8);
+
+    const int settings[] = { params.enemy_speed, params.enemy_fire_rate, params.boss_speed, params.boss_fire_rate, params.boss_health,
+                             params.formation_columns, params.formation_rows, params.formation_spacing, params.enemy_volley, params.lives };
+    put_uint(out, sizeof(settings) / sizeof(settings[0]), 2);
+    for (int value : settings)
+        put_uint(out, static_cast<std::uint32_t>(value), 4);
+
+    put_uint(out, ticks, 8);
+    put_uint(out, static_cast<unsigned>(outcome), 1);
+    put_uint(out, checksum, 8);
+
+    put_uint(out, changes.size(), 4);
+    long long previous = 0;
+    for (const ReplayChange& change : changes) {
+        put_varint(out, change.tick - previous);
+        out.push_back(static_cast<char>(change.buttons));
+        previous = change.tick;
+    }
+
+    std::ofstream file(path.c_str(), std::ios::binary);
+    file.write(out.data(), out.size());
+    return static_cast<bool>(file);
+}
+
+
+/** Reads a replay from a file. On failure the replay is left unchanged.
+ * @param path is the path of the file
+ * @param error receives the reason if the file could not be read
+ * @return true if the replay was read
+ */
+bool Replay::load(const std::string& path, std::string& error) {
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    const std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    ReplayReader in(data);
+    if (data.compare(0, sizeof(replay_magic), replay_magic, sizeof(replay_magic)) != 0) {
+        error = path + " is not a replay";
+        return false;
+    }
+    in.position = sizeof(replay_magic);
+    const std::uint64_t file_version = in.uint(2);
+    if (in.failed) {
+        error = path + " is truncated";
+        return false;
+    }
+    if (file_version != version) {
+        error = path + " was recorded with another version of the game";
+        return false;
+    }
+    in.uint(2);
+
+    Replay loaded;
+    loaded.seed = in.uint(8);
+
+    int settings[10] = {};
+    const std::uint64_t setting_count = in.uint(2);
+    if (in.failed) {
+        error = path + " is truncated";
+        return false;
+    }
+    if (setting_count != sizeof(settings) / sizeof(settings[0])) {
+        error = path + " has unknown settings";
+        return false;
+    }
+    for (int& value : settings)
+        value = static_cast<std::int32_t>(in.uint(4));
+    const GameParams params = { settings[0], settings[1], settings[2], settings[3], settings[4],
+                                settings[5], settings[6], settings[7], settings[8], settings[9] };
+    loaded.params = params;
+
+    loaded.ticks = static_cast<long long>(in.uint(8));
+    const std::uint64_t outcome = in.uint(1);
+    loaded.outcome = static_cast<GameOutcome>(outcome);
+    loaded.checksum = in.uint(8);
+    if (in.failed) {
+        error = path + " is truncated";
+        return false;
+    }
+
+    // the settings drive the timers and the sizes of the pools, so settings that could hang or exhaust memory are refused
+    if (!valid_params(params) || loaded.ticks < 0 || outcome > static_cast<std::uint64_t>(GameOutcome::Won)) {
+        error = path + " is damaged";
+        return false;
+    }
+
+    // every change takes at least two bytes, which bounds the count before anything is allocated
+    const std::uint64_t change_count = in.uint(4);
+    if (in.failed || change_count > (data.size() - in.position) / 2) {
+        error = path + " is truncated";
+        return false;
+    }
+    loaded.changes.resize(change_count);
+    long long tick = 0;
+    for (ReplayChange& change : loaded.changes) {
+        tick += static_cast<long long>(in.varint());
+        change.tick = tick;
+        change.buttons = static_cast<unsigned char>(in.uint(1));
+    }
+    if (in.failed) {
+        error = path + " is truncated";
+        return false;
+    }
+
+    *this = loaded;
+    return true;
+}
+
+
+/** Constructor for ReplayPlayer.
+ * @param new_replay is the replay to play back from its first tick. It has to outlive the player.
+ */
+ReplayPlayer::ReplayPlayer(const Replay* new_replay) :
+    replay(new_replay),
+    tick(0),
+    next_change(0),
+    buttons(0)
+{
+}
+
+
+/** Returns the controls of the next tick of the replay. Past its end, no control is pressed.
+ * @param input receives the controls
+ */
+void ReplayPlayer::consume(GameInput& input) {
+    const std::vector<ReplayChange>& changes = replay->get_changes();
+    if (next_change < changes.size() && changes[next_change].tick == tick)
+        buttons = changes[next_change++].buttons;
+    if (is_finished())
+        buttons = 0;
+    ++tick;
+
+    input.left = (buttons & button_left) != 0;
+    input.right = (buttons & button_right) != 0;
+    input.fire = (buttons & button_fire) != 0;
+}
+
+
+/** Returns true once every recorded tick has been played.
+ */
+bool ReplayPlayer::is_finished() const {
+    return tick >= replay->get_ticks();
+}
+
+
+/** Resets a GameState to the start of a recorded session.
+ * @param state is the state to reset
+ * @param replay is the recording
+ */
+void start_replay(GameState& state, const Replay& replay) {
+    state.reset(replay.get_params(), replay.get_seed());
+}
+
+
+/** Returns true if a state that played a replay to its end ended exactly like the recorded session.
+ * @param state is the state that played the replay
+ * @param replay is the recording
+ */
+bool replay_matches(const GameState& state, const Replay& replay) {
+    return state.get_ticks() == replay.get_ticks() && state.get_outcome() == replay.get_outcome() && state.checksum() == replay.get_checksum();
+}
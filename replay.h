@@ -0,0 +1,99 @@
+/** @file replay.h
+ * @brief Contains declarations for the Replay and ReplayPlayer classes, which record a session and play it back tick by tick.
+ *
+ * A session is fully determined by its settings, the seed of its random number generator and the controls of every
+ * tick, so that is all a replay stores. Controls are stored only when they change, as the number of ticks since the
+ * previous change followed by the new controls.
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "gamestate.h"
+
+
+
+/** @struct ReplayChange
+ * @brief The controls from one tick on, until the next change
+ */
+struct ReplayChange
+{
+    long long tick;
+    unsigned char buttons;
+};
+
+
+
+/** @class Replay
+ * @brief A recorded session: its settings, seed, the changes of the controls, and how it ended
+ *
+ * The file starts with the magic "SIRP" and a version. All numbers are little endian, and tick gaps are stored as
+ * variable length integers of 7 bits per byte, so a long session with steady controls stays small.
+ */
+class Replay
+{
+public:
+    // current version of the file layout and of the random numbers it relies on. Version 2 has the RandomGenerator of each session,
+    // and version 3 checksums the enemies as a Formation.
+    static const unsigned version = 3;
+
+    // changes of the controls reserved when recording starts, so that recording does not allocate while ticks run. A player
+    // changes the controls a few times per second at most, so this lasts for hours of play.
+    static const std::size_t reserved_changes = 1 << 16;
+
+    Replay();
+
+    void start(const GameState& state);
+    void record(const GameInput& input);
+    void finish(const GameState& state);
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path, std::string& error);
+
+    const GameParams& get_params() const { return params; }
+    std::uint64_t get_seed() const { return seed; }
+    long long get_ticks() const { return ticks; }
+    GameOutcome get_outcome() const { return outcome; }
+    std::uint64_t get_checksum() const { return checksum; }
+    const std::vector<ReplayChange>& get_changes() const { return changes; }
+
+private:
+    GameParams params;
+    std::uint64_t seed;
+    std::vector<ReplayChange> changes;
+
+    // length, result and final GameState::checksum() of the session, to check that playing it back gives the same game
+    long long ticks;
+    GameOutcome outcome;
+    std::uint64_t checksum;
+};
+
+
+
+/** @class ReplayPlayer
+ * @brief Feeds the controls of a replay to a GameState, one tick at a time
+ */
+class ReplayPlayer : public InputSource
+{
+public:
+    explicit ReplayPlayer(const Replay* new_replay = nullptr);
+
+    void consume(GameInput& input) override;
+    bool is_finished() const;
+
+private:
+    const Replay* replay;
+    long long tick;
+    std::size_t next_change;
+    unsigned char buttons;
+};
+
+void start_replay(GameState& state, const Replay& replay);
+bool replay_matches(const GameState& state, const Replay& replay);
+
+
+
+#endif // REPLAY_H
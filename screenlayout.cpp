@@ -0,0 +1,136 @@
+/** @file screenlayout.cpp
+ * @brief Contains implementation of the screen layout functions and the DirtyTracker class. These list what a GameState draws and find what changed between frames.
+ */
+
+#include "screenlayout.h"
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+
+
+/** Orders boxes by every field, so that equal boxes are next to each other after sorting.
+ */
+bool operator<(const DrawBox& a, const DrawBox& b) {
+    return std::tie(a.kind, a.frame, a.left, a.top, a.width, a.height) < std::tie(b.kind, b.frame, b.left, b.top, b.width, b.height);
+}
+
+
+/** Two boxes are equal if they draw the same thing at the same place.
+ */
+bool operator==(const DrawBox& a, const DrawBox& b) {
+    return std::tie(a.kind, a.frame, a.left, a.top, a.width, a.height) == std::tie(b.kind, b.frame, b.left, b.top, b.width, b.height);
+}
+
+
+/** Adds the box of a sprite drawn at the given position.
+ */
+static void add_box(std::vector<DrawBox>& boxes, int kind, int frame, int x, int y, const SpriteBox& box) {
+    const DrawBox draw_box = { kind, frame, x + box.dx, y + box.dy, box.width, box.height };
+    boxes.push_back(draw_box);
+}
+
+
+/** Returns the width of the boss health bar, which shrinks by the same amount for every hit.
+ * @param state is the session the bar belongs to
+ */
+int health_bar_width(const GameState& state) {
+    const int total_boss_health = state.get_total_boss_health();
+    return health_bar_box.width - (health_bar_box.width/total_boss_health)*(total_boss_health - state.get_boss_health());
+}
+
+
+/** Lists everything that Gameboard::paintEvent() draws for the given state. The three cases are the same as those of paintEvent():
+ * the boss battle, the time between the last enemy and the boss, and the first level.
+ * @param state is the session being drawn
+ * @param boxes receives the boxes. It is cleared first.
+ */
+void list_draw_boxes(const GameState& state, std::vector<DrawBox>& boxes) {
+    boxes.clear();
+
+    const std::pair<int,int> player_position = state.get_player_position();
+    const Formation& enemies = state.get_enemies();
+    const BulletArray& player_bullets = state.get_player_bullets();
+    const BulletArray& enemy_bullets = state.get_enemy_bullets();
+    const BulletArray& boss_bullets = state.get_boss_bullets();
+
+    // the "Lives Remaining" label and a ship for each life left, in every case
+    add_box(boxes, draw_lives_label, 0, 0, 0, lives_label_box);
+    for (int i = 0; i < state.get_lives_count()-1; ++i)
+        add_box(boxes, draw_lives_icon, 0, lives_icon_spacing*i, 0, lives_icon_box);
+
+    if (state.is_alive())
+        add_box(boxes, draw_player, 0, player_position.first, player_position.second, player_box);
+    for (size_t i = 0, n = player_bullets.size(); i < n; ++i)
+        add_box(boxes, draw_player_bullet, 0, player_bullets.x[i], player_bullets.y[i], bullet_box);
+    for (const auto& x : state.get_explosion_locations())
+        add_box(boxes, draw_explosion, x.second, x.first.first, x.first.second, explosion_box);
+
+    if (state.is_boss_battle()) {
+        add_box(boxes, draw_boss_health_label, 0, 0, 0, boss_health_label_box);
+
+        for (size_t i = 0, n = boss_bullets.size(); i < n; ++i) {
+            if (boss_bullets.kind[i] == boss_shot_left)
+                add_box(boxes, draw_boss_bullet_left, 0, boss_bullets.x[i], boss_bullets.y[i], boss_side_bullet_box);
+            if (boss_bullets.kind[i] == boss_shot_down)
+                add_box(boxes, draw_enemy_bullet, 0, boss_bullets.x[i], boss_bullets.y[i], bullet_box);
+            if (boss_bullets.kind[i] == boss_shot_right)
+                add_box(boxes, draw_boss_bullet_right, 0, boss_bullets.x[i], boss_bullets.y[i], boss_side_bullet_box);
+        }
+
+        if (state.is_boss_alive()) {
+            const SpriteBox bar = { health_bar_box.dx, health_bar_box.dy, health_bar_width(state) + 1, health_bar_box.height + 1 };
+            add_box(boxes, draw_health_bar, 0, 0, 0, bar);
+            add_box(boxes, draw_boss, 0, state.get_boss_position().first, state.get_boss_position().second, boss_box);
+        }
+
+        if (state.get_boss_health() == 0) {
+            const std::pair<std::pair<int,int>, int>& boss_explosion_location = state.get_boss_explosion_location();
+            add_box(boxes, draw_boss_explosion, boss_explosion_location.second, boss_explosion_location.first.first, boss_explosion_location.first.second, boss_explosion_box);
+        }
+
+        if (state.is_win_message())
+            add_box(boxes, draw_win_message, 0, 0, 0, win_message_box);
+    }
+    else {
+        enemies.for_each([&](int x, int y) { add_box(boxes, draw_invader, 0, x, y, invader_box); });
+        for (size_t i = 0, n = enemy_bullets.size(); i < n; ++i)
+            add_box(boxes, draw_enemy_bullet, 0, enemy_bullets.x[i], enemy_bullets.y[i], bullet_box);
+
+        if (enemies.empty() && state.is_boss_message())
+            add_box(boxes, draw_boss_message, 0, 0, 0, boss_message_box);
+    }
+}
+
+
+/** Constructor for DirtyTracker. The first update repaints the whole board.
+ */
+DirtyTracker::DirtyTracker() :
+    full(true)
+{
+}
+
+
+/** Forgets the previous frame, so that the next update repaints the whole board. Use when the board was repainted for another reason, or a new session starts.
+ */
+void DirtyTracker::invalidate() {
+    full = true;
+}
+
+
+/** Compares what the given state draws with what was drawn at the previous update. The boxes that changed are available from get_changed().
+ * @param state is the session being drawn
+ * @return true if the whole board has to be repainted, in which case get_changed() is empty
+ */
+bool DirtyTracker::update(const GameState& state) {
+    list_draw_boxes(state, current);
+    std::sort(current.begin(), current.end());
+
+    changed.clear();
+    const bool repaint_all = full;
+    if (!full)
+        std::set_symmetric_difference(previous.begin(), previous.end(), current.begin(), current.end(), std::back_inserter(changed));
+
+    full = false;
+    previous.swap(current);
+    return repaint_all;
+}
@@ -0,0 +1,122 @@
+/** @file screenlayout.h
+ * @brief Contains where everything of a GameState is drawn on screen, and the DirtyTracker class, which finds the parts of the screen that changed.
+ *
+ * Painting and dirty tracking both use the boxes below, so the areas that are repainted always cover what is drawn.
+ */
+
+#ifndef SCREENLAYOUT_H
+#define SCREENLAYOUT_H
+
+#include <vector>
+#include "gamestate.h"
+
+
+
+/** @struct SpriteBox
+ * @brief Where a sprite is drawn relative to the position of its entity, and its size on screen
+ */
+struct SpriteBox
+{
+    int dx;
+    int dy;
+    int width;
+    int height;
+};
+
+static const SpriteBox invader_box = { -12, 0, 35, 23 };
+static const SpriteBox player_box = { -10, 0, 30, 30 };
+static const SpriteBox bullet_box = { 0, 0, 11, 15 };
+static const SpriteBox boss_side_bullet_box = { 0, 0, 20, 20 };
+static const SpriteBox explosion_box = { -10, 0, 30, 30 };
+static const SpriteBox boss_box = { -50, 0, 100, 53 };
+static const SpriteBox boss_explosion_box = { -40, 0, 80, 80 };
+
+// labels and messages, relative to the top left corner of the board. The n-th life icon is drawn lives_icon_spacing*n to the right of the first.
+static const SpriteBox lives_label_box = { 0, 10, 182, 26 };
+static const SpriteBox lives_icon_box = { 175, 10, 25, 25 };
+static const int lives_icon_spacing = 30;
+static const SpriteBox boss_health_label_box = { 0, 50, 138, 26 };
+static const SpriteBox boss_message_box = { 90, 100, 534, 54 };
+static const SpriteBox win_message_box = { 170, 100, 385, 54 };
+
+// the boss health bar at full health. Its outline adds one pixel to the right and bottom.
+static const SpriteBox health_bar_box = { 10, 40, 680, 10 };
+
+// area at the top of the board that holds the lives and boss health labels, the life icons and the health bar
+static const SpriteBox hud_box = { 0, 0, 700, 80 };
+
+
+
+/** @enum DrawKind
+ * @brief Everything that can be drawn on the board. Two boxes of the same kind, frame and place look the same.
+ */
+enum DrawKind
+{
+    draw_lives_label,
+    draw_lives_icon,
+    draw_boss_health_label,
+    draw_health_bar,
+    draw_invader,
+    draw_player,
+    draw_player_bullet,
+    draw_enemy_bullet,
+    draw_boss_bullet_left,
+    draw_boss_bullet_right,
+    draw_explosion,
+    draw_boss,
+    draw_boss_explosion,
+    draw_boss_message,
+    draw_win_message
+};
+
+
+
+/** @struct DrawBox
+ * @brief One thing drawn on the board: what it is, its animation frame and the area it covers
+ */
+struct DrawBox
+{
+    int kind;
+    int frame;
+    int left;
+    int top;
+    int width;
+    int height;
+};
+
+bool operator<(const DrawBox& a, const DrawBox& b);
+bool operator==(const DrawBox& a, const DrawBox& b);
+
+int health_bar_width(const GameState& state);
+void list_draw_boxes(const GameState& state, std::vector<DrawBox>& boxes);
+
+
+
+/** @class DirtyTracker
+ * @brief Finds the areas of the board that changed between two frames
+ *
+ * Each frame, everything that would be drawn is listed as a DrawBox and compared with the list of the previous frame.
+ * A box that is in only one of the two lists has appeared, disappeared, moved or changed frame, so it has to be
+ * repainted; a box that is in both is left alone.
+ */
+class DirtyTracker
+{
+public:
+    DirtyTracker();
+
+    void invalidate();
+    bool update(const GameState& state);
+    const std::vector<DrawBox>& get_changed() const { return changed; }
+
+private:
+    std::vector<DrawBox> previous;
+    std::vector<DrawBox> current;
+    std::vector<DrawBox> changed;
+
+    // true if nothing is known about the previous frame, so the whole board has to be repainted
+    bool full;
+};
+
+
+
+#endif // SCREENLAYOUT_H
@@ -0,0 +1,67 @@
+/** @file scriptedplayer.cpp
+ * @brief Contains implementation of ScriptedPlayer class. This class plays headless sessions for the batch runner.
+ */
+
+#include "scriptedplayer.h"
+#include <cstdlib>
+
+
+/** Decides which keys the bot holds down for the next tick.
+ * @param state is the session being played
+ * @return the state of the controls for the next tick
+ */
+GameInput ScriptedPlayer::next_input(const GameState& state) const {
+    GameInput input;
+    input.left = false;
+    input.right = false;
+    input.fire = true;
+
+    const std::pair<int,int> player = state.get_player_position();
+    if (!state.is_alive())
+        return input;
+
+    // dodge the closest bullet that is falling towards the player
+    int threat_x = 0;
+    int threat_distance = 1000;
+    const BulletArray* hostile[] = { &state.get_enemy_bullets(), &state.get_boss_bullets() };
+    for (const BulletArray* bullets : hostile) {
+        for (size_t i = 0, n = bullets->size(); i < n; ++i) {
+            if (std::abs(bullets->x[i] - player.first) < 25 && bullets->y[i] < player.second && player.second - bullets->y[i] < threat_distance) {
+                threat_distance = player.second - bullets->y[i];
+                threat_x = bullets->x[i];
+            }
+        }
+    }
+
+    if (threat_distance < 120) {
+
+        // move away from the bullet, unless the player is pinned against the side of the screen
+        if ((threat_x >= player.first && player.first > 40) || player.first > 650)
+            input.left = true;
+        else
+            input.right = true;
+        return input;
+    }
+
+    // otherwise line up with the boss or the closest enemy
+    int target_x = player.first;
+    if (state.is_boss_battle()) {
+        target_x = state.get_boss_position().first;
+    }
+    else {
+        int best = 1000;
+        state.get_enemies().for_each_column([&](int x) {
+            if (std::abs(x - player.first) < best) {
+                best = std::abs(x - player.first);
+                target_x = x;
+            }
+        });
+    }
+
+    if (target_x < player.first - 5)
+        input.left = true;
+    else if (target_x > player.first + 5)
+        input.right = true;
+
+    return input;
+}
@@ -0,0 +1,24 @@
+/** @file scriptedplayer.h
+ * @brief Contains declarations for the ScriptedPlayer class, a simple bot that plays a GameState without a human.
+ */
+
+#ifndef SCRIPTEDPLAYER_H
+#define SCRIPTEDPLAYER_H
+
+#include "gamestate.h"
+
+
+
+/** @class ScriptedPlayer
+ * @brief Computes the player's controls for each tick of a headless session
+ *
+ * The bot holds down fire, dodges bullets that are about to hit it and otherwise moves below the closest enemy or the boss.
+ */
+class ScriptedPlayer
+{
+public:
+    GameInput next_input(const GameState& state) const;
+};
+
+
+#endif // SCRIPTEDPLAYER_H
@@ -0,0 +1,39 @@
+/** @file simdpath.cpp
+ * @brief Contains the detection of the SIMD instruction sets the CPU supports.
+ */
+
+#include "simdpath.h"
+
+
+/** Identifies the CPU. Only called once, by best_simd_path().
+ */
+static SimdPath detect_simd_path() {
+#ifdef SIMDPATH_X86
+    // the CPU has to be identified explicitly, because this may run while static variables are initialized
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return simd_avx2;
+    if (__builtin_cpu_supports("sse2"))
+        return simd_sse2;
+#endif
+    return simd_scalar;
+}
+
+
+/** Returns the fastest path the CPU supports. The CPU is identified on the first call, which is safe from any thread.
+ */
+SimdPath best_simd_path() {
+    static const SimdPath best = detect_simd_path();
+    return best;
+}
+
+
+/** Returns a printable name for a path.
+ */
+const char* simd_path_name(SimdPath path) {
+    switch (path) {
+    case simd_avx2: return "avx2";
+    case simd_sse2: return "sse2";
+    default: return "scalar";
+    }
+}
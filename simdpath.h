@@ -0,0 +1,83 @@
+/** @file simdpath.h
+ * @brief Contains the choice between the scalar, SSE2 and AVX2 versions of a kernel, shared by every kernel that has them.
+ */
+
+#ifndef SIMDPATH_H
+#define SIMDPATH_H
+
+#include <atomic>
+
+// defined where the SSE2 and AVX2 versions of kernels can be compiled with target attributes
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMDPATH_X86 1
+#endif
+
+
+
+/** @enum SimdPath
+ * @brief Implementations of a kernel, from the most portable to the fastest
+ */
+enum SimdPath { simd_scalar, simd_sse2, simd_avx2, simd_path_count };
+
+SimdPath best_simd_path();
+const char* simd_path_name(SimdPath path);
+
+
+
+/** @class KernelDispatch
+ * @brief The versions of one kernel and the one in use
+ *
+ * The constructor is constexpr, so a dispatch at namespace scope is initialized before any code runs and can be used
+ * while other static variables are initialized. The fastest version the CPU supports is chosen on first use. Every
+ * version of a kernel has to give identical results, so the version may be changed at any time, even while other
+ * threads run the kernel.
+ */
+template <class Kernel>
+class KernelDispatch
+{
+public:
+    // kernels that are not compiled for this CPU are given as the scalar one
+    constexpr KernelDispatch(Kernel scalar, Kernel sse2, Kernel avx2) : kernels{ scalar, sse2, avx2 }, active(-1) {}
+
+    Kernel kernel() const { return kernels[path()]; }
+    SimdPath path() const;
+    bool set_path(SimdPath new_path);
+
+private:
+    Kernel kernels[simd_path_count];
+
+    // path in use, or -1 until it is chosen
+    mutable std::atomic<int> active;
+};
+
+
+
+/** Returns the path of the kernel in use, choosing the fastest one the CPU supports on first use.
+ */
+template <class Kernel>
+SimdPath KernelDispatch<Kernel>::path() const {
+    int current = active.load(std::memory_order_relaxed);
+    if (current < 0) {
+        // threads that get here at the same time all choose the same path, so the first one to store it wins
+        active.compare_exchange_strong(current, best_simd_path(), std::memory_order_relaxed);
+        current = active.load(std::memory_order_relaxed);
+    }
+    return static_cast<SimdPath>(current);
+}
+
+
+/** Chooses the version of the kernel to use, e.g. to compare them. Paths the CPU does not support are refused.
+ * @param new_path is the version to use
+ * @return true if the version was chosen
+ */
+template <class Kernel>
+bool KernelDispatch<Kernel>::set_path(SimdPath new_path) {
+    if (new_path < simd_scalar || new_path > best_simd_path())
+        return false;
+    active.store(new_path, std::memory_order_relaxed);
+    return true;
+}
+
+
+
+#endif // SIMDPATH_H
@@ -0,0 +1,364 @@
+/** @file snapshot.cpp
+ * @brief Contains implementation of the save state functions of GameState, and of reading and writing snapshot files.
+ *
+ * These functions live apart from the rules of the game in gamestate.cpp, but they are members of GameState because a
+ * snapshot has to reach every private variable of the session.
+ */
+
+#include "snapshot.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+// first bytes of every snapshot
+static const char snapshot_magic[4] = { 'S', 'I', 'S', 'S' };
+
+static_assert(sizeof(SnapshotHeader) % 8 == 0, "arrays after the snapshot header must start 8 byte aligned");
+
+
+/** Copies a SimTimer into its snapshot layout.
+ */
+static SnapshotTimer store_timer(const SimTimer& timer) {
+    const SnapshotTimer stored = { timer.interval, timer.elapsed, timer.active, timer.single_shot };
+    return stored;
+}
+
+
+/** Copies a SimTimer back from its snapshot layout.
+ */
+static void load_timer(SimTimer& timer, const SnapshotTimer& stored) {
+    timer.interval = stored.interval;
+    timer.elapsed = stored.elapsed;
+    timer.active = stored.active != 0;
+    timer.single_shot = stored.single_shot != 0;
+}
+
+
+/** Appends an array to a snapshot, starting at the next multiple of 8 bytes, and records where it went.
+ */
+static void append_section(std::vector<unsigned char>& out, SnapshotSpan& span, const void* data, std::size_t bytes) {
+    out.resize((out.size() + 7) & ~std::size_t(7));
+    span.offset = out.size();
+    span.bytes = bytes;
+    if (bytes > 0) {
+        const unsigned char* first = static_cast<const unsigned char*>(data);
+        out.insert(out.end(), first, first + bytes);
+    }
+}
+
+
+/** Checks that an array lies inside the snapshot, is aligned, and holds a whole number of elements.
+ * @return the number of elements, or -1 if the section is damaged
+ */
+static long long section_count_of(const SnapshotHeader& header, std::size_t size, SnapshotSection section, std::size_t element_size) {
+    const SnapshotSpan& span = header.sections[section];
+    if (span.offset < sizeof(SnapshotHeader) || span.offset % 8 != 0 || span.offset > size || span.bytes > size - span.offset || span.bytes % element_size != 0)
+        return -1;
+    return static_cast<long long>(span.bytes / element_size);
+}
+
+
+/** Copies an array out of a snapshot whose sections were checked with section_count_of().
+ */
+template <class T>
+static void load_section(std::vector<T>& values, const unsigned char* data, const SnapshotHeader& header, SnapshotSection section) {
+    const SnapshotSpan& span = header.sections[section];
+    values.resize(span.bytes / sizeof(T));
+    if (span.bytes > 0)
+        std::memcpy(values.data(), data + span.offset, span.bytes);
+}
+
+
+/** Writes the state of the session to a snapshot: the header with every variable that is not an array, followed by the
+ * entity arrays as they are in memory. The recorder and the hit masks are not stored.
+ * @param out receives the snapshot. Its memory is reused.
+ */
+void GameState::save_snapshot(std::vector<unsigned char>& out) const {
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, snapshot_magic, sizeof(snapshot_magic));
+    header.version = snapshot_version;
+    header.byte_order = snapshot_byte_order;
+    header.header_size = sizeof(SnapshotHeader);
+
+    header.seed = seed;
+    header.ticks = ticks;
+    std::copy(generator.state, generator.state + 4, header.random_state);
+    const std::size_t peaks[] = { peak_counts.enemies, peak_counts.player_bullets, peak_counts.enemy_bullets, peak_counts.boss_bullets, peak_counts.explosions };
+    for (int i = 0; i < 5; ++i)
+        header.peak_counts[i] = peaks[i];
+
+    const int settings[] = { params.enemy_speed, params.enemy_fire_rate, params.boss_speed, params.boss_fire_rate, params.boss_health,
+                             params.formation_columns, params.formation_rows, params.formation_spacing, params.enemy_volley, params.lives };
+    std::copy(settings, settings + 10, header.params);
+    header.accumulator = accumulator;
+    header.outcome = static_cast<std::int32_t>(outcome);
+
+    header.explosion_timer = store_timer(explosion_timer);
+    header.boss_explosion_timer = store_timer(boss_explosion_timer);
+    header.boss_battle_timer = store_timer(boss_battle_timer);
+    header.game_over_timer = store_timer(game_over_timer);
+    header.win_message_timer = store_timer(win_message_timer);
+    header.move_timer = store_timer(move_timer);
+    header.shoot_timer = store_timer(shoot_timer);
+    header.respawn_timer = store_timer(respawn_timer);
+    header.enemy_timer = store_timer(enemy_timer);
+    header.bullet_timer = store_timer(bullet_timer);
+    header.enemy_fire_bullet_timer = store_timer(enemy_fire_bullet_timer);
+    header.boss_move_timer = store_timer(boss_move_timer);
+    header.boss_fire_rate_timer = store_timer(boss_fire_rate_timer);
+
+    header.player_position[0] = player_position.first;
+    header.player_position[1] = player_position.second;
+    header.alive = alive;
+    header.moving_right = moving_right;
+    header.lives_count = lives_count;
+
+    const int layout[] = { enemies.get_columns(), enemies.get_rows(), enemies.get_left(), enemies.get_top(), enemies.get_pitch_x(), enemies.get_pitch_y() };
+    std::copy(layout, layout + 6, header.formation);
+
+    header.boss_position[0] = boss_position.first;
+    header.boss_position[1] = boss_position.second;
+    header.boss_explosion_location[0] = boss_explosion_location.first.first;
+    header.boss_explosion_location[1] = boss_explosion_location.first.second;
+    header.boss_explosion_location[2] = boss_explosion_location.second;
+    header.boss_message = boss_message;
+    header.start_boss_battle = start_boss_battle;
+    header.boss_moving_right = boss_moving_right;
+    header.boss_health = boss_health;
+    header.total_boss_health = total_boss_health;
+    header.win_message = win_message;
+    header.boss_alive = boss_alive;
+
+    // the header is written last, once the place of every array is known
+    out.assign(sizeof(SnapshotHeader), 0);
+    const std::vector<std::uint64_t>& masks = enemies.get_row_masks();
+    append_section(out, header.sections[section_formation], masks.data(), masks.size() * sizeof(std::uint64_t));
+
+    const BulletArray* bullets[] = { &player_bullets, &enemy_bullets, &boss_bullets };
+    const SnapshotSection first_sections[] = { section_player_bullet_x, section_enemy_bullet_x, section_boss_bullet_x };
+    for (int i = 0; i < 3; ++i) {
+        const BulletArray& array = *bullets[i];
+        SnapshotSpan* spans = header.sections + first_sections[i];
+        append_section(out, spans[0], array.x.data(), array.size() * sizeof(int));
+        append_section(out, spans[1], array.y.data(), array.size() * sizeof(int));
+        append_section(out, spans[2], array.vx.data(), array.size() * sizeof(int));
+        append_section(out, spans[3], array.vy.data(), array.size() * sizeof(int));
+        append_section(out, spans[4], array.kind.data(), array.size());
+    }
+
+    // explosions are pairs of pairs in memory, so they are written as plain triples
+    std::vector<std::int32_t> explosions;
+    explosions.reserve(explosion_locations.size() * 3);
+    for (const auto& explosion : explosion_locations) {
+        explosions.push_back(explosion.first.first);
+        explosions.push_back(explosion.first.second);
+        explosions.push_back(explosion.second);
+    }
+    append_section(out, header.sections[section_explosions], explosions.data(), explosions.size() * sizeof(std::int32_t));
+
+    header.total_size = out.size();
+    std::memcpy(out.data(), &header, sizeof(header));
+}
+
+
+/** Replaces the session with one from a snapshot. The header is read in place and each array is copied out with one
+ * memcpy, so the snapshot can be a file mapped into memory. The hit masks only live within a tick,
+ * and the recorder is left as it is. On failure the session is left unchanged.
+ * @param data is the first byte of the snapshot
+ * @param size is the size of the snapshot in bytes
+ * @param error receives the reason if the snapshot could not be restored
+ * @return true if the session was restored
+ */
+bool GameState::restore_snapshot(const unsigned char* data, std::size_t size, std::string& error) {
+    if (size < sizeof(snapshot_magic) || std::memcmp(data, snapshot_magic, sizeof(snapshot_magic)) != 0) {
+        error = "not a snapshot";
+        return false;
+    }
+    if (size < sizeof(SnapshotHeader)) {
+        error = "snapshot is truncated";
+        return false;
+    }
+    SnapshotHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.version != snapshot_version || header.byte_order != snapshot_byte_order || header.header_size != sizeof(SnapshotHeader)) {
+        error = "snapshot was saved by another version of the game";
+        return false;
+    }
+    if (header.total_size != size) {
+        error = "snapshot is truncated";
+        return false;
+    }
+
+    // every array has to be inside the snapshot, and the arrays of a group of bullets have to be the same length
+    long long counts[section_count];
+    const std::size_t element_sizes[section_count] = { sizeof(std::uint64_t),
+                                                       sizeof(int), sizeof(int), sizeof(int), sizeof(int), 1,
+                                                       sizeof(int), sizeof(int), sizeof(int), sizeof(int), 1,
+                                                       sizeof(int), sizeof(int), sizeof(int), sizeof(int), 1,
+                                                       3 * sizeof(std::int32_t) };
+    for (int section = 0; section < section_count; ++section) {
+        counts[section] = section_count_of(header, size, static_cast<SnapshotSection>(section), element_sizes[section]);
+        if (counts[section] < 0) {
+            error = "snapshot is damaged";
+            return false;
+        }
+    }
+    const std::uint64_t* random_state = header.random_state;
+    bool consistent = (random_state[0] | random_state[1] | random_state[2] | random_state[3]) != 0
+                      && header.outcome >= static_cast<int>(GameOutcome::Playing) && header.outcome <= static_cast<int>(GameOutcome::Won);
+    const SnapshotSection first_sections[] = { section_player_bullet_x, section_enemy_bullet_x, section_boss_bullet_x };
+    for (SnapshotSection first : first_sections) {
+        for (int i = 1; i < 5; ++i)
+            consistent = consistent && counts[first + i] == counts[first];
+
+        // the kind of a bullet indexes the velocity tables and the sprites
+        const unsigned char* kinds = data + header.sections[first + 4].offset;
+        for (long long i = 0; consistent && i < counts[first]; ++i)
+            consistent = kinds[i] < bullet_kind_count;
+    }
+
+    // the settings and every timer interval have to be playable, since a timer with an interval of 0 times out forever, and the boss health is drawn as a fraction of its total
+    const std::int32_t* settings = header.params;
+    const GameParams loaded_params = { settings[0], settings[1], settings[2], settings[3], settings[4], settings[5], settings[6], settings[7], settings[8], settings[9] };
+    consistent = consistent && valid_params(loaded_params)
+                 && header.total_boss_health > 0 && header.boss_health >= 0 && header.boss_health <= header.total_boss_health
+                 && header.lives_count <= loaded_params.lives;
+    const SnapshotTimer* timers[] = { &header.explosion_timer, &header.boss_explosion_timer, &header.boss_battle_timer, &header.game_over_timer,
+                                      &header.win_message_timer, &header.move_timer, &header.shoot_timer, &header.respawn_timer, &header.enemy_timer,
+                                      &header.bullet_timer, &header.enemy_fire_bullet_timer, &header.boss_move_timer, &header.boss_fire_rate_timer };
+    for (const SnapshotTimer* timer : timers)
+        consistent = consistent && timer->interval > 0 && timer->elapsed >= 0;
+
+    // the formation never grows past the grid of its settings, so the layout cannot ask for more memory than a session of them
+    const std::int32_t* layout = header.formation;
+    consistent = consistent && layout[0] >= 0 && layout[0] <= loaded_params.formation_columns && layout[1] >= 0 && layout[1] <= loaded_params.formation_rows;
+
+    // the frame of an explosion indexes its sprites
+    const unsigned char* explosions = data + header.sections[section_explosions].offset;
+    for (long long i = 0; consistent && i < counts[section_explosions]; ++i) {
+        std::int32_t frame;
+        std::memcpy(&frame, explosions + i * 3 * sizeof(std::int32_t) + 2 * sizeof(std::int32_t), sizeof(frame));
+        consistent = frame >= 0 && frame < explosion_frames;
+    }
+    consistent = consistent && header.boss_explosion_location[2] >= 0 && header.boss_explosion_location[2] < explosion_frames;
+    if (!consistent) {
+        error = "snapshot is damaged";
+        return false;
+    }
+
+    // the formation checks its masks against its size, and is the last thing that can fail, so nothing else has changed if it does
+    const std::uint64_t* masks = reinterpret_cast<const std::uint64_t*>(data + header.sections[section_formation].offset);
+    if (!enemies.restore(layout[0], layout[1], layout[2], layout[3], layout[4], layout[5], masks, static_cast<std::size_t>(counts[section_formation]))) {
+        error = "snapshot is damaged";
+        return false;
+    }
+
+    params = loaded_params;
+    seed = header.seed;
+    reserve_pools();
+    std::copy(random_state, random_state + 4, generator.state);
+    accumulator = header.accumulator;
+    ticks = header.ticks;
+    outcome = static_cast<GameOutcome>(header.outcome);
+    peak_counts.enemies = header.peak_counts[0];
+    peak_counts.player_bullets = header.peak_counts[1];
+    peak_counts.enemy_bullets = header.peak_counts[2];
+    peak_counts.boss_bullets = header.peak_counts[3];
+    peak_counts.explosions = header.peak_counts[4];
+    overflows = EntityCounts();
+
+    // results of the collide phase only live within a tick
+    bullet_step = false;
+    enemies_hit = false;
+    player_was_hit = false;
+    boss_hits = 0;
+    dead_enemies.clear();
+    dead_player_bullets.clear();
+    dead_enemy_bullets.clear();
+    dead_boss_bullets.clear();
+
+    load_timer(explosion_timer, header.explosion_timer);
+    load_timer(boss_explosion_timer, header.boss_explosion_timer);
+    load_timer(boss_battle_timer, header.boss_battle_timer);
+    load_timer(game_over_timer, header.game_over_timer);
+    load_timer(win_message_timer, header.win_message_timer);
+    load_timer(move_timer, header.move_timer);
+    load_timer(shoot_timer, header.shoot_timer);
+    load_timer(respawn_timer, header.respawn_timer);
+    load_timer(enemy_timer, header.enemy_timer);
+    load_timer(bullet_timer, header.bullet_timer);
+    load_timer(enemy_fire_bullet_timer, header.enemy_fire_bullet_timer);
+    load_timer(boss_move_timer, header.boss_move_timer);
+    load_timer(boss_fire_rate_timer, header.boss_fire_rate_timer);
+
+    BulletArray* bullets[] = { &player_bullets, &enemy_bullets, &boss_bullets };
+    for (int i = 0; i < 3; ++i) {
+        BulletArray& array = *bullets[i];
+        load_section(array.x, data, header, first_sections[i]);
+        load_section(array.y, data, header, static_cast<SnapshotSection>(first_sections[i] + 1));
+        load_section(array.vx, data, header, static_cast<SnapshotSection>(first_sections[i] + 2));
+        load_section(array.vy, data, header, static_cast<SnapshotSection>(first_sections[i] + 3));
+        load_section(array.kind, data, header, static_cast<SnapshotSection>(first_sections[i] + 4));
+    }
+
+    explosion_locations.resize(static_cast<std::size_t>(counts[section_explosions]));
+    for (auto& explosion : explosion_locations) {
+        std::int32_t values[3];
+        std::memcpy(values, explosions, sizeof(values));
+        explosion = std::make_pair(std::make_pair(values[0], values[1]), values[2]);
+        explosions += sizeof(values);
+    }
+
+    player_position = std::make_pair(header.player_position[0], header.player_position[1]);
+    alive = header.alive != 0;
+    moving_right = header.moving_right != 0;
+    lives_count = header.lives_count;
+
+    boss_position = std::make_pair(header.boss_position[0], header.boss_position[1]);
+    boss_explosion_location = std::make_pair(std::make_pair(header.boss_explosion_location[0], header.boss_explosion_location[1]), header.boss_explosion_location[2]);
+    boss_message = header.boss_message != 0;
+    start_boss_battle = header.start_boss_battle != 0;
+    boss_moving_right = header.boss_moving_right != 0;
+    boss_health = header.boss_health;
+    total_boss_health = header.total_boss_health;
+    win_message = header.win_message != 0;
+    boss_alive = header.boss_alive != 0;
+    return true;
+}
+
+
+/** Writes a snapshot of a session to a file.
+ * @param state is the session
+ * @param path is the path of the file, which is replaced if it exists
+ * @return true if the file was written
+ */
+bool save_snapshot_file(const GameState& state, const std::string& path) {
+    std::vector<unsigned char> snapshot;
+    state.save_snapshot(snapshot);
+    std::ofstream file(path.c_str(), std::ios::binary);
+    file.write(reinterpret_cast<const char*>(snapshot.data()), snapshot.size());
+    return static_cast<bool>(file);
+}
+
+
+/** Restores a session from a snapshot file. The file is read whole and restored from memory; the game maps the file instead.
+ * @param state is the session to replace
+ * @param path is the path of the file
+ * @param error receives the reason if the file could not be restored
+ * @return true if the session was restored
+ */
+bool load_snapshot_file(GameState& state, const std::string& path, std::string& error) {
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    const std::vector<unsigned char> snapshot((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (!state.restore_snapshot(snapshot.data(), snapshot.size(), error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+}
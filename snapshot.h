@@ -0,0 +1,140 @@
+/** @file snapshot.h
+ * @brief Contains the layout of a save state: a fixed-size header followed by the entity arrays of a GameState.
+ *
+ * A snapshot is the memory of a GameState written out as is, so restoring it is a bounds check and one copy per array.
+ * All numbers are in the byte order of the machine that wrote them, which byte_order records. Snapshots are meant to
+ * resume a session on the same build of the game, e.g. after a restart, and are rejected by any other version.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "gamestate.h"
+
+
+
+/** @enum SnapshotSection
+ * @brief Arrays stored after the header of a snapshot, in the order they are written
+ */
+enum SnapshotSection
+{
+    section_formation,          // bitmask of the live enemies of each row, Formation::get_row_masks()
+    section_player_bullet_x,
+    section_player_bullet_y,
+    section_player_bullet_vx,
+    section_player_bullet_vy,
+    section_player_bullet_kind,
+    section_enemy_bullet_x,
+    section_enemy_bullet_y,
+    section_enemy_bullet_vx,
+    section_enemy_bullet_vy,
+    section_enemy_bullet_kind,
+    section_boss_bullet_x,
+    section_boss_bullet_y,
+    section_boss_bullet_vx,
+    section_boss_bullet_vy,
+    section_boss_bullet_kind,
+    section_explosions,         // x, y and frame of each explosion
+    section_count
+};
+
+
+
+/** @struct SnapshotSpan
+ * @brief Where an array starts in a snapshot, relative to its first byte, and how many bytes it takes
+ */
+struct SnapshotSpan
+{
+    std::uint64_t offset;
+    std::uint64_t bytes;
+};
+
+
+
+/** @struct SnapshotTimer
+ * @brief A SimTimer as it is stored in a snapshot: its interval, the time it has run and its flags
+ */
+struct SnapshotTimer
+{
+    std::int32_t interval;
+    std::int32_t elapsed;
+    std::int32_t active;
+    std::int32_t single_shot;
+};
+
+
+
+/** @struct SnapshotHeader
+ * @brief Everything in a GameState that is not an array, and where each array is stored
+ *
+ * Fields are ordered from the widest to the narrowest so that the struct has no padding, and every array starts at a
+ * multiple of 8 bytes, so a snapshot in a mapped file can be read in place.
+ */
+struct SnapshotHeader
+{
+    char magic[4];                  // "SISS"
+    std::uint32_t version;
+    std::uint32_t byte_order;       // snapshot_byte_order as the writer stored it
+    std::uint32_t header_size;      // sizeof(SnapshotHeader) of the writer
+    std::uint64_t total_size;       // size of the whole snapshot in bytes
+
+    SnapshotSpan sections[section_count];
+
+    std::uint64_t seed;
+    std::int64_t ticks;
+    std::uint64_t random_state[4];  // RandomGenerator::state
+    std::uint64_t peak_counts[5];   // enemies, player bullets, enemy bullets, boss bullets and explosions
+
+    std::int32_t params[10];        // GameParams in the order they are declared
+    std::int32_t accumulator;
+    std::int32_t outcome;
+
+    SnapshotTimer explosion_timer;
+    SnapshotTimer boss_explosion_timer;
+    SnapshotTimer boss_battle_timer;
+    SnapshotTimer game_over_timer;
+    SnapshotTimer win_message_timer;
+    SnapshotTimer move_timer;
+    SnapshotTimer shoot_timer;
+    SnapshotTimer respawn_timer;
+    SnapshotTimer enemy_timer;
+    SnapshotTimer bullet_timer;
+    SnapshotTimer enemy_fire_bullet_timer;
+    SnapshotTimer boss_move_timer;
+    SnapshotTimer boss_fire_rate_timer;
+
+    std::int32_t player_position[2];
+    std::int32_t alive;
+    std::int32_t moving_right;
+    std::int32_t lives_count;
+
+    std::int32_t formation[6];      // columns, rows, left, top, pitch_x and pitch_y of the enemy formation
+
+    std::int32_t boss_position[2];
+    std::int32_t boss_explosion_location[3];
+    std::int32_t boss_message;
+    std::int32_t start_boss_battle;
+    std::int32_t boss_moving_right;
+    std::int32_t boss_health;
+    std::int32_t total_boss_health;
+    std::int32_t win_message;
+    std::int32_t boss_alive;
+    std::int32_t reserved;          // keeps the size a multiple of 8. Written as 0.
+};
+
+// current version of the snapshot layout
+static const std::uint32_t snapshot_version = 3;
+
+// written in the byte order of the machine, so a snapshot from a machine with the other byte order is recognized
+static const std::uint32_t snapshot_byte_order = 0x01020304;
+
+bool save_snapshot_file(const GameState& state, const std::string& path);
+bool load_snapshot_file(GameState& state, const std::string& path, std::string& error);
+
+
+
+#endif // SNAPSHOT_H
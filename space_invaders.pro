@@ -0,0 +1,14 @@
+#-------------------------------------------------
+#
+# Builds the game together with its command-line tools and benchmarks
+#
+#-------------------------------------------------
+
+TEMPLATE = subdirs
+
+SUBDIRS += game \
+    batch_runner \
+    benchmarks
+
+game.file = Qt_game.pro
+game.makefile = Makefile.game
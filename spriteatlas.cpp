@@ -0,0 +1,162 @@
+/** @file spriteatlas.cpp
+ * @brief Contains implementation of SpriteAtlas and SpriteBatch classes. These classes pack the gameplay sprites into one pixmap and draw them in batches.
+ */
+
+#include "spriteatlas.h"
+#include <QImage>
+#include <algorithm>
+
+
+// width of the atlas, unless a sprite is wider. Sprites that do not fit in the current row start a new one.
+static const int atlas_width = 1024;
+
+// transparent border around each sprite
+static const int sprite_padding = 1;
+
+
+/** Constructor for SpriteAtlas. The atlas is empty until build() is called.
+ */
+SpriteAtlas::SpriteAtlas() :
+    sources(sprite_count),
+    sizes(sprite_count)
+{
+}
+
+
+/** Packs the given sprites into the atlas.
+ * @param sprites are the images of the sprites, indexed by SpriteId, scaled to the size they are drawn at. Their device pixel ratio gives their size on screen.
+ */
+void SpriteAtlas::build(const std::vector<QPixmap>& sprites) {
+    sources.assign(sprites.size(), QRect());
+    sizes.assign(sprites.size(), QSize());
+
+    // place the tallest sprites first, so that the rows waste as little space as possible
+    std::vector<int> order(sprites.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        order[i] = static_cast<int>(i);
+    std::stable_sort(order.begin(), order.end(), [&sprites](int a, int b) { return sprites[a].height() > sprites[b].height(); });
+
+    int width_limit = atlas_width;
+    for (const QPixmap& sprite : sprites)
+        width_limit = std::max(width_limit, sprite.width() + 2*sprite_padding);
+
+    int x = 0;
+    int y = 0;
+    int row_height = 0;
+    for (int i : order) {
+        const int width = sprites[i].width() + 2*sprite_padding;
+        const int height = sprites[i].height() + 2*sprite_padding;
+
+        // start a new row if the sprite does not fit in the current one
+        if (x + width > width_limit && x > 0) {
+            y += row_height;
+            x = 0;
+            row_height = 0;
+        }
+        sources[i] = QRect(x + sprite_padding, y + sprite_padding, sprites[i].width(), sprites[i].height());
+        sizes[i] = QSize(qRound(sprites[i].width() / sprites[i].devicePixelRatio()), qRound(sprites[i].height() / sprites[i].devicePixelRatio()));
+        x += width;
+        row_height = std::max(row_height, height);
+    }
+
+    QImage image(width_limit, std::max(1, y + row_height), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    QPainter p(&image);
+    p.setCompositionMode(QPainter::CompositionMode_Source);
+    for (size_t i = 0; i < sprites.size(); ++i)
+        p.drawPixmap(sources[i], sprites[i]);
+    p.end();
+
+    atlas = QPixmap::fromImage(image);
+    atlas_image = image;
+}
+
+
+/** Returns the pixels of one sprite for the software blitter.
+ * @param sprite is the SpriteId of the sprite
+ */
+ConstImageView SpriteAtlas::sprite_pixels(int sprite) const {
+    const QRect& source = sources[sprite];
+    return sub_image(image_view(atlas_image), source.x(), source.y(), source.width(), source.height());
+}
+
+
+/** Constructor for SpriteBatch.
+ * @param new_atlas is the atlas that every sprite of the batch comes from. It must be set before sprites are added.
+ */
+SpriteBatch::SpriteBatch(const SpriteAtlas* new_atlas) :
+    atlas(new_atlas)
+{
+}
+
+
+/** Changes the atlas that sprites come from. Sprites that were added but not drawn yet are dropped.
+ * @param new_atlas is the new atlas
+ */
+void SpriteBatch::set_atlas(const SpriteAtlas* new_atlas) {
+    atlas = new_atlas;
+    items.clear();
+}
+
+
+/** Adds a sprite to the batch. The sprite is drawn at the size it was packed at.
+ * @param sprite is the SpriteId of the sprite
+ * @param x is the left edge of the sprite on screen
+ * @param y is the top edge of the sprite on screen
+ */
+void SpriteBatch::add(int sprite, int x, int y) {
+    const Item item = { sprite, x, y };
+    items.push_back(item);
+}
+
+
+/** Draws every sprite in the batch with QPainter and empties it. The buffers are kept, so that the next layer does not allocate.
+ * @param p is the painter to draw with
+ */
+void SpriteBatch::draw(QPainter& p) {
+    if (items.empty())
+        return;
+
+    fragments.resize(0);
+    for (const Item& item : items) {
+        const QRect& source = atlas->source(item.sprite);
+        const QSize& size = atlas->size(item.sprite);
+
+        // a fragment is positioned by its center. The only scaling left is from device pixels to logical pixels, which is none at a device pixel ratio of 1.
+        fragments.append(QPainter::PixmapFragment::create(QPointF(item.x + size.width()/2.0, item.y + size.height()/2.0), QRectF(source),
+                                                          qreal(size.width())/source.width(), qreal(size.height())/source.height()));
+    }
+    p.drawPixmapFragments(fragments.constData(), fragments.size(), atlas->pixmap());
+    items.clear();
+}
+
+
+/** Blends every sprite in the batch into an image with the software blitter and empties the batch. Sprites are copied 1:1, because the atlas is already scaled for the pixel ratio.
+ * @param target is the image, in device pixels
+ * @param origin_x is the position of the left edge of target on screen, in device pixels
+ * @param origin_y is the position of the top edge of target on screen, in device pixels
+ * @param dpr is the device pixel ratio the atlas was scaled for
+ */
+void SpriteBatch::blit(const ImageView& target, int origin_x, int origin_y, qreal dpr) {
+    for (const Item& item : items)
+        blend_image(target, qRound(item.x * dpr) - origin_x, qRound(item.y * dpr) - origin_y, atlas->sprite_pixels(item.sprite));
+    items.clear();
+}
+
+
+/** Returns the pixels of a premultiplied ARGB32 image for the software blitter.
+ * @param image is the image
+ */
+ImageView image_view(QImage& image) {
+    const ImageView view = { reinterpret_cast<std::uint32_t*>(image.bits()), image.width(), image.height(), image.bytesPerLine() / 4 };
+    return view;
+}
+
+
+/** Returns the pixels of a read-only premultiplied ARGB32 image for the software blitter.
+ * @param image is the image
+ */
+ConstImageView image_view(const QImage& image) {
+    const ConstImageView view = { reinterpret_cast<const std::uint32_t*>(image.constBits()), image.width(), image.height(), image.bytesPerLine() / 4 };
+    return view;
+}
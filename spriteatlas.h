@@ -0,0 +1,114 @@
+/** @file spriteatlas.h
+ * @brief Contains declarations for the SpriteAtlas and SpriteBatch classes, which draw the gameplay sprites from one packed pixmap.
+ */
+
+#ifndef SPRITEATLAS_H
+#define SPRITEATLAS_H
+
+#include <QImage>
+#include <QPixmap>
+#include <QPainter>
+#include <QRect>
+#include <QVector>
+#include <vector>
+#include "spriteblit.h"
+
+
+
+/** @enum SpriteId
+ * @brief Every sprite that can be drawn during a game, at the size it is drawn at. An image drawn at two sizes is two sprites.
+ * The explosion frames are consecutive, so frame n is sprite_explosion + n.
+ */
+enum SpriteId
+{
+    sprite_invader,
+    sprite_spaceship,
+    sprite_lives_icon,
+    sprite_player_bullet,
+    sprite_enemy_bullet,
+    sprite_enemy_bullet_left,
+    sprite_enemy_bullet_right,
+    sprite_boss,
+    sprite_boss_text,
+    sprite_win_text,
+    sprite_lives_remaining,
+    sprite_boss_health,
+    sprite_explosion,
+    sprite_boss_explosion = sprite_explosion + 14,
+    sprite_count = sprite_boss_explosion + 14
+};
+
+
+
+/** @class SpriteAtlas
+ * @brief All gameplay sprites packed into a single pixmap
+ *
+ * Sprites are packed already scaled to the size they are drawn at, in rows from the tallest to the shortest, with a
+ * transparent border between them. Because every sprite comes from the same pixmap, a whole layer can be handed to
+ * QPainter in one call, and because they are already scaled, drawing them is a 1:1 copy.
+ */
+class SpriteAtlas
+{
+public:
+    SpriteAtlas();
+
+    void build(const std::vector<QPixmap>& sprites);
+
+    const QPixmap& pixmap() const { return atlas; }
+    const QImage& image() const { return atlas_image; }
+    ConstImageView sprite_pixels(int sprite) const;
+    const QRect& source(int sprite) const { return sources[sprite]; }
+    const QSize& size(int sprite) const { return sizes[sprite]; }
+
+private:
+    // the atlas for QPainter, and the same pixels in memory for the software blitter
+    QPixmap atlas;
+    QImage atlas_image;
+
+    // area of each sprite inside the atlas in device pixels, and its size on screen in logical pixels. Indexed by SpriteId.
+    std::vector<QRect> sources;
+    std::vector<QSize> sizes;
+};
+
+
+
+/** @class SpriteBatch
+ * @brief Collects sprite draws from one atlas and submits them with a single QPainter::drawPixmapFragments() call, or blends them into an image with the software blitter
+ *
+ * Sprites are drawn in the order they were added, so a batch can hold everything between two draws that do not come
+ * from the atlas.
+ */
+class SpriteBatch
+{
+public:
+    explicit SpriteBatch(const SpriteAtlas* new_atlas = nullptr);
+
+    void set_atlas(const SpriteAtlas* new_atlas);
+    void add(int sprite, int x, int y);
+    void draw(QPainter& p);
+    void blit(const ImageView& target, int origin_x, int origin_y, qreal dpr);
+
+private:
+    /** @struct Item
+     * @brief One sprite of the batch and its top left corner on screen
+     */
+    struct Item
+    {
+        int sprite;
+        int x;
+        int y;
+    };
+
+    const SpriteAtlas* atlas;
+    std::vector<Item> items;
+    QVector<QPainter::PixmapFragment> fragments;
+};
+
+
+
+ImageView image_view(QImage& image);
+ConstImageView image_view(const QImage& image);
+
+
+
+#endif // SPRITEATLAS_H
@@ -0,0 +1,203 @@
+/** @file spriteblit.cpp
+ * @brief Contains implementation of the software blitter. The blend kernel has a scalar, an SSE2 and an AVX2 version, chosen on first use.
+ *
+ * Every version computes dst = src + dst*(255 - src_alpha)/255 per channel with the same rounding, so they produce
+ * identical pixels. The SIMD versions are compiled with target attributes, so the rest of the program does not need
+ * to be built for those instruction sets.
+ */
+
+#include "spriteblit.h"
+#include <algorithm>
+
+#ifdef SIMDPATH_X86
+#include <immintrin.h>
+#endif
+
+
+// blends one row of count pixels of src over dst
+typedef void (*BlendRow)(std::uint32_t* dst, const std::uint32_t* src, int count);
+
+
+/** Returns a*b/255 rounded to the nearest integer, for a and b between 0 and 255.
+ */
+static inline std::uint32_t mul_255(std::uint32_t a, std::uint32_t b) {
+    const std::uint32_t t = a*b + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+
+/** Portable blend kernel. Fully transparent and fully opaque pixels are handled without arithmetic.
+ */
+static void blend_row_scalar(std::uint32_t* dst, const std::uint32_t* src, int count) {
+    for (int i = 0; i < count; ++i) {
+        const std::uint32_t s = src[i];
+        const std::uint32_t alpha = s >> 24;
+        if (alpha == 0)
+            continue;
+        if (alpha == 255) {
+            dst[i] = s;
+            continue;
+        }
+
+        const std::uint32_t d = dst[i];
+        const std::uint32_t inverse = 255 - alpha;
+        dst[i] = s + (mul_255(d & 0xff, inverse)
+                      | mul_255((d >> 8) & 0xff, inverse) << 8
+                      | mul_255((d >> 16) & 0xff, inverse) << 16
+                      | mul_255(d >> 24, inverse) << 24);
+    }
+}
+
+
+#ifdef SIMDPATH_X86
+
+/** Blends the 8 channels of two pixels, widened to 16 bits, with their inverse alphas. Same rounding as mul_255().
+ */
+__attribute__((target("sse2")))
+static inline __m128i mul_255_sse2(__m128i channels, __m128i inverse) {
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(channels, inverse), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+
+/** SSE2 blend kernel. Blends 4 pixels at a time and skips groups that are fully transparent.
+ */
+__attribute__((target("sse2")))
+static void blend_row_sse2(std::uint32_t* dst, const std::uint32_t* src, int count) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi32(255);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(s, zero)) == 0xffff)
+            continue;
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+
+        // inverse alpha of each pixel, copied into both 16 bit halves of its 32 bit lane
+        __m128i inverse = _mm_sub_epi32(full, _mm_srli_epi32(s, 24));
+        inverse = _mm_or_si128(inverse, _mm_slli_epi32(inverse, 16));
+
+        const __m128i low = mul_255_sse2(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi32(inverse, inverse));
+        const __m128i high = mul_255_sse2(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi32(inverse, inverse));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi8(s, _mm_packus_epi16(low, high)));
+    }
+    blend_row_scalar(dst + i, src + i, count - i);
+}
+
+
+/** Blends the 16 channels of four pixels, widened to 16 bits, with their inverse alphas. Same rounding as mul_255().
+ */
+__attribute__((target("avx2")))
+static inline __m256i mul_255_avx2(__m256i channels, __m256i inverse) {
+    __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(channels, inverse), _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+
+/** AVX2 blend kernel. Blends 8 pixels at a time and skips groups that are fully transparent. Unpacking and packing both work
+ * within 128 bit lanes, so the pixels come out in the order they went in.
+ */
+__attribute__((target("avx2")))
+static void blend_row_avx2(std::uint32_t* dst, const std::uint32_t* src, int count) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i full = _mm256_set1_epi32(255);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        if (_mm256_testz_si256(s, s))
+            continue;
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+
+        __m256i inverse = _mm256_sub_epi32(full, _mm256_srli_epi32(s, 24));
+        inverse = _mm256_or_si256(inverse, _mm256_slli_epi32(inverse, 16));
+
+        const __m256i low = mul_255_avx2(_mm256_unpacklo_epi8(d, zero), _mm256_unpacklo_epi32(inverse, inverse));
+        const __m256i high = mul_255_avx2(_mm256_unpackhi_epi8(d, zero), _mm256_unpackhi_epi32(inverse, inverse));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_add_epi8(s, _mm256_packus_epi16(low, high)));
+    }
+
+    // the tail is not handed to the SSE2 kernel, because switching from AVX to legacy SSE instructions stalls some CPUs
+    blend_row_scalar(dst + i, src + i, count - i);
+}
+
+#endif
+
+
+#ifdef SIMDPATH_X86
+// kernel used by blend_image(). The fastest one the CPU supports is chosen on first use.
+static KernelDispatch<BlendRow> blend_row(blend_row_scalar, blend_row_sse2, blend_row_avx2);
+#else
+static KernelDispatch<BlendRow> blend_row(blend_row_scalar, blend_row_scalar, blend_row_scalar);
+#endif
+
+
+/** Returns the kernel that blend_image() uses.
+ */
+SimdPath active_blit_path() {
+    return blend_row.path();
+}
+
+
+/** Chooses the kernel that blend_image() uses, e.g. to compare them. Paths the CPU does not support are refused.
+ * @param path is the kernel to use
+ * @return true if the kernel was chosen
+ */
+bool set_blit_path(SimdPath path) {
+    return blend_row.set_path(path);
+}
+
+
+/** Returns the part of an image inside the given rectangle. The rectangle is clipped to the image.
+ */
+ImageView sub_image(const ImageView& image, int x, int y, int width, int height) {
+    const int left = std::max(x, 0);
+    const int top = std::max(y, 0);
+    const int right = std::min(x + width, image.width);
+    const int bottom = std::min(y + height, image.height);
+    const ImageView view = { image.pixels + top*image.stride + left, std::max(right - left, 0), std::max(bottom - top, 0), image.stride };
+    return view;
+}
+
+
+/** Returns the part of a read-only image inside the given rectangle. The rectangle is clipped to the image.
+ */
+ConstImageView sub_image(const ConstImageView& image, int x, int y, int width, int height) {
+    const int left = std::max(x, 0);
+    const int top = std::max(y, 0);
+    const int right = std::min(x + width, image.width);
+    const int bottom = std::min(y + height, image.height);
+    const ConstImageView view = { image.pixels + top*image.stride + left, std::max(right - left, 0), std::max(bottom - top, 0), image.stride };
+    return view;
+}
+
+
+/** Sets every pixel of an image to one color.
+ * @param target is the image
+ * @param color is a premultiplied ARGB32 color
+ */
+void fill_image(const ImageView& target, std::uint32_t color) {
+    for (int row = 0; row < target.height; ++row)
+        std::fill(target.pixels + row*target.stride, target.pixels + row*target.stride + target.width, color);
+}
+
+
+/** Draws a sprite over an image, blending it by its alpha. The parts of the sprite that fall outside the image are skipped.
+ * @param target is the image drawn into
+ * @param x is the left edge of the sprite in target pixels
+ * @param y is the top edge of the sprite in target pixels
+ * @param sprite is the sprite
+ */
+void blend_image(const ImageView& target, int x, int y, const ConstImageView& sprite) {
+    const int left = std::max(x, 0);
+    const int top = std::max(y, 0);
+    const int right = std::min(x + sprite.width, target.width);
+    const int bottom = std::min(y + sprite.height, target.height);
+    if (left >= right || top >= bottom)
+        return;
+
+    const BlendRow blend = blend_row.kernel();
+    for (int row = top; row < bottom; ++row)
+        blend(target.pixels + row*target.stride + left, sprite.pixels + (row - y)*sprite.stride + (left - x), right - left);
+}
@@ -0,0 +1,50 @@
+/** @file spriteblit.h
+ * @brief Contains the software blitter, which alpha blends premultiplied ARGB32 sprites into an image with SSE2 or AVX2 where the CPU supports them.
+ */
+
+#ifndef SPRITEBLIT_H
+#define SPRITEBLIT_H
+
+#include <cstdint>
+#include "simdpath.h"
+
+
+
+/** @struct ImageView
+ * @brief Rectangle of premultiplied ARGB32 pixels inside a larger image. The stride is the distance between rows in pixels.
+ */
+struct ImageView
+{
+    std::uint32_t* pixels;
+    int width;
+    int height;
+    int stride;
+};
+
+
+
+/** @struct ConstImageView
+ * @brief Read-only rectangle of premultiplied ARGB32 pixels inside a larger image. The stride is the distance between rows in pixels.
+ */
+struct ConstImageView
+{
+    const std::uint32_t* pixels;
+    int width;
+    int height;
+    int stride;
+};
+
+
+
+ImageView sub_image(const ImageView& image, int x, int y, int width, int height);
+ConstImageView sub_image(const ConstImageView& image, int x, int y, int width, int height);
+
+void fill_image(const ImageView& target, std::uint32_t color);
+void blend_image(const ImageView& target, int x, int y, const ConstImageView& sprite);
+
+SimdPath active_blit_path();
+bool set_blit_path(SimdPath path);
+
+
+
+#endif // SPRITEBLIT_H
@@ -0,0 +1,66 @@
+/** @file spritecache.cpp
+ * @brief Contains implementation of SpriteCache class. This class scales every image once to the size it is drawn at.
+ */
+
+#include "spritecache.h"
+#include <QElapsedTimer>
+
+
+/** Constructor for SpriteCache. The cache starts empty.
+ */
+SpriteCache::SpriteCache() :
+    lookups(0)
+{
+}
+
+
+/** Returns an image at the size it was stored at, decoding it the first time it is requested.
+ * @param path is the resource path of the image
+ * @return the decoded image
+ */
+const QPixmap& SpriteCache::image(const QString& path) {
+    ++lookups;
+    return decoded(path);
+}
+
+
+/** Returns an image at the size it was stored at, decoding it the first time. Not counted as a lookup, so that a scaled() miss is counted once.
+ * @param path is the resource path of the image
+ * @return the decoded image
+ */
+const QPixmap& SpriteCache::decoded(const QString& path) {
+    QHash<QString, QPixmap>::iterator it = images.find(path);
+    if (it == images.end()) {
+        QElapsedTimer clock;
+        clock.start();
+        it = images.insert(path, QPixmap(path));
+        decode_times.add(clock.nsecsElapsed() / 1e6);
+    }
+    return it.value();
+}
+
+
+/** Returns an image scaled to the size it is drawn at, scaling it the first time that size is requested. The pixmap has the
+ * given device pixel ratio, so drawing it at its position without a target size copies it pixel for pixel.
+ * @param path is the resource path of the image
+ * @param size is the size of the image on screen in logical pixels. An invalid size keeps the size of the image.
+ * @param dpr is the device pixel ratio of the widget the image is drawn on
+ * @return the scaled image
+ */
+const QPixmap& SpriteCache::scaled(const QString& path, const QSize& size, qreal dpr) {
+    ++lookups;
+    const SpriteKey key = { path, size, dpr };
+    QHash<SpriteKey, QPixmap>::iterator it = scaled_images.find(key);
+    if (it != scaled_images.end())
+        return it.value();
+
+    // nearest neighbour scaling gives the same pixels QPainter produced when it scaled the images while drawing
+    const QPixmap& source = decoded(path);
+    QElapsedTimer clock;
+    clock.start();
+    const QSize logical_size = size.isValid() ? size : source.size();
+    QPixmap result = source.scaled(logical_size * dpr, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+    result.setDevicePixelRatio(dpr);
+    scale_times.add(clock.nsecsElapsed() / 1e6);
+    return scaled_images.insert(key, result).value();
+}
@@ -0,0 +1,69 @@
+/** @file spritecache.h
+ * @brief Contains declarations for the SpriteCache class, which keeps images scaled to the size they are drawn at.
+ */
+
+#ifndef SPRITECACHE_H
+#define SPRITECACHE_H
+
+#include <QHash>
+#include <QPixmap>
+#include <QSize>
+#include <QString>
+#include "timingstats.h"
+
+
+
+/** @struct SpriteKey
+ * @brief Identifies one scaled version of an image: the resource it comes from, its size on screen and the device pixel ratio it is drawn at
+ */
+struct SpriteKey
+{
+    QString path;
+    QSize size;
+    qreal dpr;
+};
+
+inline bool operator==(const SpriteKey& a, const SpriteKey& b) {
+    return a.path == b.path && a.size == b.size && a.dpr == b.dpr;
+}
+
+inline uint qHash(const SpriteKey& key, uint seed = 0) {
+    return qHash(key.path, seed) ^ qHash(key.size.width() * 4099 + key.size.height(), seed) ^ qHash(key.dpr, seed);
+}
+
+
+
+/** @class SpriteCache
+ * @brief Decodes images once and scales each of them once per size and device pixel ratio
+ *
+ * QPainter resamples a pixmap every time it is drawn at a size that differs from its own. Drawing the pixmaps of this
+ * cache at their logical size instead is a plain 1:1 copy. The time spent decoding and scaling is recorded, so that
+ * loading costs can be reported.
+ */
+class SpriteCache
+{
+public:
+    SpriteCache();
+
+    const QPixmap& image(const QString& path);
+    const QPixmap& scaled(const QString& path, const QSize& size, qreal dpr);
+
+    const TimingStats& get_decode_times() const { return decode_times; }
+    const TimingStats& get_scale_times() const { return scale_times; }
+    long long get_lookups() const { return lookups; }
+
+private:
+    const QPixmap& decoded(const QString& path);
+
+    QHash<QString, QPixmap> images;
+    QHash<SpriteKey, QPixmap> scaled_images;
+
+    // time spent on each decode and scale, and the number of requests including those served from the cache
+    TimingStats decode_times;
+    TimingStats scale_times;
+    long long lookups;
+};
+
+
+
+#endif // SPRITECACHE_H
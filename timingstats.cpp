@@ -0,0 +1,83 @@
+/** @file timingstats.cpp
+ * @brief Contains implementation of TimingStats class. This class summarizes frame times, latencies and other measurements.
+ */
+
+#include "timingstats.h"
+#include <algorithm>
+#include <cmath>
+
+
+/** Constructor for TimingStats.
+ * @param new_capacity is the number of most recent samples that are kept
+ */
+TimingStats::TimingStats(std::size_t new_capacity) :
+    capacity(new_capacity > 0 ? new_capacity : 1),
+    next(0),
+    added(0),
+    sum(0)
+{
+    samples.reserve(capacity);
+}
+
+
+/** Records a measurement. Once the buffer is full, the oldest measurement is replaced.
+ * @param ms is the measured time in milliseconds
+ */
+void TimingStats::add(double ms) {
+    if (samples.size() < capacity) {
+        samples.push_back(ms);
+    }
+    else {
+        samples[next] = ms;
+        next = (next + 1) % capacity;
+    }
+    ++added;
+    sum += ms;
+}
+
+
+/** Removes all measurements.
+ */
+void TimingStats::clear() {
+    samples.clear();
+    next = 0;
+    added = 0;
+    sum = 0;
+}
+
+
+/** Returns the mean of the kept measurements, or 0 if there are none.
+ */
+double TimingStats::mean() const {
+    if (samples.empty())
+        return 0;
+
+    double kept = 0;
+    for (double x : samples)
+        kept += x;
+    return kept / samples.size();
+}
+
+
+/** Returns a percentile of the kept measurements, or 0 if there are none.
+ * @param p is the percentile between 0 and 100, e.g. 99 for the 99th percentile
+ */
+double TimingStats::percentile(double p) const {
+    if (samples.empty())
+        return 0;
+
+    std::vector<double> sorted(samples);
+    const double rank = std::ceil(p / 100.0 * sorted.size()) - 1;
+    const std::size_t k = rank < 0 ? 0 : std::min<std::size_t>(static_cast<std::size_t>(rank), sorted.size() - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+    return sorted[k];
+}
+
+
+/** Returns the largest of the kept measurements, or 0 if there are none.
+ */
+double TimingStats::max() const {
+    if (samples.empty())
+        return 0;
+    return *std::max_element(samples.begin(), samples.end());
+}
@@ -0,0 +1,49 @@
+/** @file timingstats.h
+ * @brief Contains declarations for the TimingStats class, which summarizes a series of time measurements.
+ */
+
+#ifndef TIMINGSTATS_H
+#define TIMINGSTATS_H
+
+#include <vector>
+#include <cstddef>
+
+
+
+/** @class TimingStats
+ * @brief Keeps the most recent time measurements and reports their mean and percentiles
+ *
+ * Only the last capacity samples are kept, so a long session does not grow memory. The count and the sum of every sample
+ * are kept as well, for totals over the whole session. The summary functions are meant for reporting and may sort a copy
+ * of the samples.
+ */
+class TimingStats
+{
+public:
+    explicit TimingStats(std::size_t new_capacity = 4096);
+
+    void add(double ms);
+    void clear();
+
+    std::size_t count() const { return samples.size(); }
+    long long total_count() const { return added; }
+    double total() const { return sum; }
+    double total_mean() const { return added > 0 ? sum / added : 0; }
+    double mean() const;
+    double percentile(double p) const;
+    double max() const;
+
+private:
+    std::size_t capacity;
+    std::vector<double> samples;
+
+    // index of the oldest sample once the buffer is full
+    std::size_t next;
+
+    // number of samples added since the last clear, including those that were overwritten, and their sum
+    long long added;
+    double sum;
+};
+
+
+#endif // TIMINGSTATS_H